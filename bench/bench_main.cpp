@@ -0,0 +1,163 @@
+#include "cube.h"
+#include "optimal.h"
+#include "random_state.h"
+#include "two_phase.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Micro-benchmarks for the cube core. Not part of ctest; run a Release build:
+//   ./build/rubcs_bench
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+template <typename Fn>
+double nsPerOp(uint64_t ops, Fn&& fn) {
+    auto start = Clock::now();
+    fn();
+    auto end = Clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(ops);
+}
+
+std::vector<std::array<Color, 54>> randomStates(size_t count, uint64_t seed) {
+    RandomStateGenerator gen(seed);
+    std::vector<std::array<Color, 54>> out;
+    out.reserve(count);
+    Cube c;
+    for (size_t i = 0; i < count; i++) {
+        c.setCubies(gen.next());
+        out.push_back(c.getState());
+    }
+    return out;
+}
+
+// Volatile sink so the optimiser keeps the measured work.
+volatile uint64_t g_sink = 0;
+
+void benchIsSolvable() {
+    auto states = randomStates(4096, 1);
+    constexpr uint64_t kIters = 2'000'000;
+    // setState drops the cubie cache, so each copy of a prepared cube does the full
+    // identification when asked; setState itself is timed separately.
+    std::vector<Cube> prepared(states.size());
+    for (size_t i = 0; i < states.size(); i++) prepared[i].setState(states[i]);
+    Cube c;
+    uint64_t ok = 0;
+    double ns = nsPerOp(kIters, [&] {
+        for (uint64_t i = 0; i < kIters; i++) {
+            c = prepared[i & (prepared.size() - 1)];
+            ok += c.isSolvable();
+        }
+    });
+    double setNs = nsPerOp(kIters, [&] {
+        for (uint64_t i = 0; i < kIters; i++) {
+            c.setState(states[i & (states.size() - 1)]);
+            ok += c.isSolved();
+        }
+    });
+    g_sink = g_sink + ok;
+    std::printf("%-28s %8.1f ns/op\n", "isSolvable", ns);
+    std::printf("%-28s %8.1f ns/op\n", "setState", setNs);
+}
+
+void benchRandomState() {
+    constexpr uint64_t kIters = 10'000'000;
+    RandomStateGenerator gen(1);
+    uint64_t acc = 0;
+    double ns = nsPerOp(kIters, [&] {
+        for (uint64_t i = 0; i < kIters; i++) acc ^= gen.nextPacked().lo;
+    });
+    g_sink = g_sink + acc;
+    std::printf("%-28s %8.1f ns/op\n", "RandomStateGenerator", ns);
+}
+
+void benchScrambleBatch() {
+    constexpr size_t kCount = 1'000'000;
+    ScrambleBatch batch;
+    double ns = nsPerOp(kCount, [&] { batch = Scrambler::batch(1, kCount, 25); });
+    g_sink = g_sink + batch.states.back().lo;
+    std::printf("%-28s %8.1f ns/op\n", "Scrambler::batch (25 moves)", ns);
+}
+
+void benchTwoPhase() {
+    TwoPhaseTables::get();  // table build is a one-off, keep it out of the timing
+    constexpr uint64_t kSolves = 200;
+    RandomStateGenerator gen(3);
+    std::vector<CubieCube> states;
+    for (uint64_t i = 0; i < kSolves; i++) states.push_back(gen.next());
+    size_t moves = 0;
+    double ns = nsPerOp(kSolves, [&] {
+        for (const auto& s : states) moves += TwoPhaseSolver::solve(s).size();
+    });
+    std::printf("%-28s %8.2f ms/op  %.2f moves\n", "TwoPhaseSolver::solve", ns / 1e6,
+                static_cast<double>(moves) / kSolves);
+}
+
+void benchOptimal() {
+    OptimalTables::get();  // several seconds, keep it out of the timing
+    constexpr uint64_t kSolves = 20;
+    constexpr int kLength = 13;
+    std::vector<CubieCube> states;
+    for (uint64_t i = 0; i < kSolves; i++)
+        states.push_back(CubieCube::fromMoves(Scrambler::generate(7, i, kLength)));
+    size_t moves = 0;
+    double ns = nsPerOp(kSolves, [&] {
+        for (const auto& s : states) moves += OptimalSolver::solve(s).size();
+    });
+    std::printf("%-28s %8.2f ms/op  %.2f moves (%d-move scrambles)\n", "OptimalSolver::solve", ns / 1e6,
+                static_cast<double>(moves) / kSolves, kLength);
+}
+
+// Uniformly random states, mostly 17-18 moves from solved: the case that matters, but one
+// that can take minutes, so each solve is cancelled after kCap.
+void benchOptimalRandom() {
+    constexpr int kStates = 3;
+    constexpr auto kCap = std::chrono::seconds(20);
+    RandomStateGenerator gen(11);
+    for (int i = 0; i < kStates; i++) {
+        CubieCube state = gen.next();
+        std::atomic_bool cancel{false};
+        SolverProgress progress;
+        std::mutex mutex;
+        std::condition_variable finished;
+        bool done = false;
+        std::thread watchdog([&] {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (!finished.wait_for(lock, kCap, [&] { return done; })) cancel = true;
+        });
+        auto start = Clock::now();
+        auto solution = OptimalSolver::solve(state, &cancel, &progress);
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            done = true;
+        }
+        finished.notify_one();
+        watchdog.join();
+        char result[32];
+        if (solution.empty()) std::snprintf(result, sizeof(result), "cut off at depth %d", progress.depth.load());
+        else std::snprintf(result, sizeof(result), "%zu moves", solution.size());
+        std::printf("%-28s %8.2f s       %s, %.1fM nodes\n", "OptimalSolver (random)", seconds, result,
+                    static_cast<double>(progress.nodes.load()) / 1e6);
+    }
+}
+
+} // namespace
+
+int main() {
+    benchIsSolvable();
+    benchRandomState();
+    benchScrambleBatch();
+    benchTwoPhase();
+    benchOptimal();
+    benchOptimalRandom();
+    return 0;
+}
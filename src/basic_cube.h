@@ -0,0 +1,250 @@
+#pragma once
+#include "cube.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+// Compile-time geometry for an NxN cube, and the one sticker model in the tree: the 3x3
+// Cube's move tables are NxnGeometry<3>'s. Facelets are face * N*N + row * N + col with
+// face order U, D, L, R, F, B.
+//
+// Layer moves are indexed depth * 18 + face * 3 + type, type 0=CW, 1=CCW, 2=half, matching
+// the Move enum for depth 0. Depth d turns the single layer d steps in from `face`; depth d
+// from a face and depth N-1-d from the opposite face are the same slice.
+//
+// The named Move values map onto an NxN as: face moves turn the outer layer, M/E/S every
+// inner layer (the middle one on 3x3, nothing on 2x2), wide moves the outer two layers, and
+// x/y/z all of them.
+template <int N>
+struct NxnGeometry {
+    static_assert(N >= 2, "an NxN cube needs at least two layers");
+
+    static constexpr int kFaceletsPerFace = N * N;
+    static constexpr int kFacelets = 6 * N * N;
+    static constexpr int kMoves = 18 * N;
+
+    using Index = std::conditional_t<(kFacelets <= 256), uint8_t, uint16_t>;
+    using Table = std::array<Index, kFacelets>;
+
+    // Layers `layers` (bit k: the k-th layer from the negative end of the axis) turned about
+    // `axis` (0 = x, 1 = y, 2 = z); turns is +-1 for a quarter turn, 2 for a half turn.
+    struct Turn {
+        int axis = 0;
+        uint32_t layers = 0;
+        int turns = 0;
+    };
+
+    static constexpr Turn layerTurn(int move) {
+        int depth = move / 18;
+        int face = move % 18 / 3;
+        return {kAxes[face], 1u << (kSides[face] > 0 ? N - 1 - depth : depth), turns(kClockwise[face], move % 3)};
+    }
+
+    static constexpr Turn moveTurn(Move m) {
+        // Per group of three after the faces (M, E, S, wide U..B, x, y, z): the face it turns like.
+        constexpr int like[12] = {FACE_L, FACE_D, FACE_F, FACE_U, FACE_D, FACE_L,
+                                  FACE_R, FACE_F, FACE_B, FACE_R, FACE_U, FACE_F};
+        int group = static_cast<int>(m) / 3;
+        int type = static_cast<int>(m) % 3;
+        if (group < 6) return layerTurn(static_cast<int>(m));
+        int face = like[group - 6];
+        uint32_t all = (1u << N) - 1;
+        uint32_t layers = all;                                    // x, y, z
+        if (group < 9) layers = all & ~(1u | (1u << (N - 1)));    // M, E, S
+        else if (group < 15) layers = kSides[face] > 0 ? 3u << (N - 2) : 3u;  // wide
+        return {kAxes[face], layers, turns(kClockwise[face], type)};
+    }
+
+    // Where sticker `index` ends up after `turn`.
+    static constexpr int stickerTarget(int index, const Turn& turn) {
+        int sign = turn.turns < 0 ? -1 : 1;
+        int reps = turn.turns < 0 ? -turn.turns : turn.turns;
+        Sticker s = stickerAt(index);
+        if ((turn.layers >> k(coord(s.pos, turn.axis))) & 1u) {
+            for (int j = 0; j < reps; j++) {
+                s.pos = rot90(s.pos, turn.axis, sign);
+                s.dir = vecDir(rot90(dirVec(s.dir), turn.axis, sign));
+            }
+        }
+        return stickerIndex(s);
+    }
+
+    // Gather form, like Cube::movePermutation: after the move, facelet i holds the sticker
+    // previously at table[i].
+    static constexpr Table buildTable(const Turn& turn) {
+        Table table{};
+        for (int i = 0; i < kFacelets; i++) table[stickerTarget(i, turn)] = static_cast<Index>(i);
+        return table;
+    }
+
+    // Layer moves, evaluated once per N into kNxnMoveTables<N>.
+    static constexpr std::array<Table, kMoves> buildTables() {
+        std::array<Table, kMoves> tables{};
+        for (int m = 0; m < kMoves; m++) tables[m] = buildTable(layerTurn(m));
+        return tables;
+    }
+
+    // Named moves, evaluated once per N into kNxnNamedMoveTables<N>.
+    static constexpr std::array<Table, static_cast<int>(Move::COUNT)> buildNamedTables() {
+        std::array<Table, static_cast<int>(Move::COUNT)> tables{};
+        for (int m = 0; m < static_cast<int>(Move::COUNT); m++) tables[m] = buildTable(moveTurn(static_cast<Move>(m)));
+        return tables;
+    }
+
+    // row * N + col of the sticker facing `face` at doubled position (x, y, z), or -1 when
+    // no sticker of that face is there.
+    static constexpr int facePosition(int face, int x, int y, int z) {
+        constexpr int o = N - 1;
+        int row = -1, col = -1;
+        switch (face) {
+        case FACE_U: if (y == o) { row = k(z); col = k(x); } break;
+        case FACE_D: if (y == -o) { row = k(-z); col = k(x); } break;
+        case FACE_L: if (x == -o) { row = k(-y); col = k(z); } break;
+        case FACE_R: if (x == o) { row = k(-y); col = k(-z); } break;
+        case FACE_F: if (z == o) { row = k(-y); col = k(x); } break;
+        case FACE_B: if (z == -o) { row = k(-y); col = k(-x); } break;
+        default: break;
+        }
+        if (row < 0 || row >= N || col < 0 || col >= N) return -1;
+        return row * N + col;
+    }
+
+private:
+    // Positions use doubled coordinates (-(N-1)..N-1 in steps of 2) so even N has integer
+    // layer centres; a sticker is a cubie position plus the direction it faces.
+    struct Vec { int x = 0, y = 0, z = 0; };
+    struct Sticker { Vec pos; int dir = FACE_U; };
+
+    // Per face: axis, side of the axis, rotation sign of a clockwise turn.
+    static constexpr int kAxes[6] = {1, 1, 0, 0, 2, 2};
+    static constexpr int kSides[6] = {1, -1, -1, 1, 1, -1};
+    static constexpr int kClockwise[6] = {-1, 1, 1, -1, -1, 1};
+
+    static constexpr int turns(int clockwise, int type) { return type == 2 ? 2 : (type == 0 ? clockwise : -clockwise); }
+
+    static constexpr int c(int k) { return 2 * k - (N - 1); }
+    // Layer of a doubled coordinate; -1 for coordinates between or outside the layers.
+    static constexpr int k(int c) { return (c + (N - 1)) % 2 != 0 ? -1 : (c + (N - 1)) / 2; }
+
+    static constexpr Sticker stickerAt(int index) {
+        int face = index / kFaceletsPerFace;
+        int row = index % kFaceletsPerFace / N;
+        int col = index % N;
+        constexpr int o = N - 1;
+        Sticker s;
+        s.dir = face;
+        if (face == FACE_U) s.pos = {c(col), o, c(row)};
+        else if (face == FACE_D) s.pos = {c(col), -o, -c(row)};
+        else if (face == FACE_L) s.pos = {-o, -c(row), c(col)};
+        else if (face == FACE_R) s.pos = {o, -c(row), -c(col)};
+        else if (face == FACE_F) s.pos = {c(col), -c(row), o};
+        else s.pos = {-c(col), -c(row), -o};
+        return s;
+    }
+
+    static constexpr int stickerIndex(const Sticker& s) {
+        return s.dir * kFaceletsPerFace + facePosition(s.dir, s.pos.x, s.pos.y, s.pos.z);
+    }
+
+    static constexpr Vec dirVec(int dir) {
+        switch (dir) {
+        case FACE_U: return {0, 1, 0};
+        case FACE_D: return {0, -1, 0};
+        case FACE_L: return {-1, 0, 0};
+        case FACE_R: return {1, 0, 0};
+        case FACE_F: return {0, 0, 1};
+        default: return {0, 0, -1};
+        }
+    }
+
+    static constexpr int vecDir(const Vec& v) {
+        if (v.y == 1) return FACE_U;
+        if (v.y == -1) return FACE_D;
+        if (v.x == -1) return FACE_L;
+        if (v.x == 1) return FACE_R;
+        if (v.z == 1) return FACE_F;
+        return FACE_B;
+    }
+
+    static constexpr Vec rot90(Vec v, int axis, int sign) {
+        if (axis == 0) return sign > 0 ? Vec{v.x, -v.z, v.y} : Vec{v.x, v.z, -v.y};
+        if (axis == 1) return sign > 0 ? Vec{v.z, v.y, -v.x} : Vec{-v.z, v.y, v.x};
+        return sign > 0 ? Vec{-v.y, v.x, v.z} : Vec{v.y, -v.x, v.z};
+    }
+
+    static constexpr int coord(const Vec& v, int axis) {
+        return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+    }
+};
+
+template <int N>
+constexpr auto kNxnMoveTables = NxnGeometry<N>::buildTables();
+template <int N>
+constexpr auto kNxnNamedMoveTables = NxnGeometry<N>::buildNamedTables();
+
+// NxN cube with facelet storage and move tables sized and generated per N at compile time.
+// BasicCube<3> is the hand-tuned Cube (see cube.h), with the same layer API; other sizes
+// use this generic engine, whose move is a plain gather over a fixed-size array.
+template <int N>
+class BasicCube {
+public:
+    using Geometry = NxnGeometry<N>;
+    static constexpr int kSize = N;
+    static constexpr int kFacelets = Geometry::kFacelets;
+    static constexpr int kMoves = Geometry::kMoves;
+
+    BasicCube() { reset(); }
+
+    void reset() {
+        for (int i = 0; i < kFacelets; i++) state_[i] = kFaceColor[i / (N * N)];
+    }
+
+    // Layer `move` as described on NxnGeometry; out-of-range values are ignored.
+    void applyMove(int move) {
+        if (move < 0 || move >= kMoves) return;
+        gather(kNxnMoveTables<N>[move]);
+    }
+    void applyMove(Face face, int depth, int type) { applyMove(moveIndex(face, depth, type)); }
+    // Any named move, mapped onto N layers as described on NxnGeometry.
+    void applyMove(Move m) {
+        if (m >= Move::COUNT) return;
+        gather(kNxnNamedMoveTables<N>[static_cast<int>(m)]);
+    }
+
+    bool isSolved() const {
+        for (int i = 0; i < kFacelets; i++) {
+            if (state_[i] != state_[i - i % (N * N)]) return false;
+        }
+        return true;
+    }
+
+    bool operator==(const BasicCube& other) const { return state_ == other.state_; }
+    bool operator!=(const BasicCube& other) const { return !(*this == other); }
+
+    Color getFacelet(int face, int row, int col) const { return state_[face * N * N + row * N + col]; }
+    const std::array<Color, kFacelets>& getState() const { return state_; }
+    void setState(const std::array<Color, kFacelets>& s) { state_ = s; }
+
+    static constexpr int moveIndex(Face face, int depth, int type) { return depth * 18 + face * 3 + type; }
+    static constexpr int inverseMove(int move) {
+        int type = move % 3;
+        return type == 2 ? move : move - type + (1 - type);
+    }
+    // Outer moves read as U, U', U2; inner layers prefix the 1-based layer number (2U, 3R').
+    static std::string moveToString(int move) {
+        std::string name = Cube::moveToString(static_cast<Move>(move % 18));
+        int depth = move / 18;
+        return depth == 0 ? name : std::to_string(depth + 1) + name;
+    }
+
+private:
+    void gather(const typename Geometry::Table& perm) {
+        std::array<Color, kFacelets> next;
+        for (int i = 0; i < kFacelets; i++) next[i] = state_[perm[i]];
+        state_ = next;
+    }
+
+    std::array<Color, kFacelets> state_;
+};
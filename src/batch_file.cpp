@@ -0,0 +1,160 @@
+#include "batch_file.h"
+
+#include <cstddef>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+constexpr char kMagic[8] = {'R', 'U', 'B', 'C', 'S', 'B', 'A', 'T'};
+
+bool validHeader(const BatchHeader& h) {
+    return std::memcmp(h.magic, kMagic, sizeof(kMagic)) == 0 && h.version == BatchFile::kVersion &&
+           h.byteOrder == BatchFile::kByteOrderMark && (h.flags & ~BatchFile::kFlagSolutions) == 0;
+}
+
+size_t strideFor(uint32_t flags) {
+    return BatchFile::kStateSize + ((flags & BatchFile::kFlagSolutions) ? BatchFile::kSolutionSlot : 0);
+}
+}
+
+BatchWriter::~BatchWriter() {
+    close();
+}
+
+bool BatchWriter::open(const std::string& path, bool withSolutions) {
+    close();
+    uint32_t flags = withSolutions ? BatchFile::kFlagSolutions : 0;
+
+    std::FILE* f = std::fopen(path.c_str(), "r+b");
+    if (f) {
+        BatchHeader h;
+        if (std::fread(&h, sizeof(h), 1, f) != 1 || !validHeader(h) || h.flags != flags) {
+            std::fclose(f);
+            return false;
+        }
+        // Continue after the last committed record; anything past it is overwritten.
+        std::fseek(f, 0, SEEK_END);
+        long end = std::ftell(f);
+        uint64_t complete = end < 0 ? 0 : (static_cast<uint64_t>(end) - BatchFile::kHeaderSize) / strideFor(flags);
+        count_ = h.count < complete ? h.count : complete;
+        if (std::fseek(f, static_cast<long>(BatchFile::kHeaderSize + count_ * strideFor(flags)), SEEK_SET) != 0) {
+            std::fclose(f);
+            return false;
+        }
+    } else {
+        f = std::fopen(path.c_str(), "w+b");
+        if (!f) return false;
+        BatchHeader h{};
+        std::memcpy(h.magic, kMagic, sizeof(kMagic));
+        h.version = BatchFile::kVersion;
+        h.flags = flags;
+        h.byteOrder = BatchFile::kByteOrderMark;
+        if (std::fwrite(&h, sizeof(h), 1, f) != 1) {
+            std::fclose(f);
+            return false;
+        }
+        count_ = 0;
+    }
+    file_ = f;
+    withSolutions_ = withSolutions;
+    return true;
+}
+
+bool BatchWriter::append(const PackedCube& state, const std::vector<Move>& solution) {
+    if (!file_) return false;
+    uint8_t record[BatchFile::kStateSize + BatchFile::kSolutionSlot] = {};
+    std::memcpy(record, &state, BatchFile::kStateSize);
+    size_t size = BatchFile::kStateSize;
+    if (withSolutions_) {
+        if (solution.size() > BatchFile::kMaxSolution) return false;
+        record[size] = static_cast<uint8_t>(solution.size());
+        for (size_t i = 0; i < solution.size(); i++) {
+            if (static_cast<unsigned>(solution[i]) >= static_cast<unsigned>(Move::COUNT)) return false;
+            record[size + 1 + i] = static_cast<uint8_t>(solution[i]);
+        }
+        size += BatchFile::kSolutionSlot;
+    }
+    if (std::fwrite(record, size, 1, file_) != 1) return false;
+    count_++;
+    return true;
+}
+
+bool BatchWriter::append(const Cube& cube, const std::vector<Move>& solution) {
+    return append(cube.packed(), solution);
+}
+
+bool BatchWriter::flush() {
+    if (!file_) return false;
+    long pos = std::ftell(file_);
+    bool ok = std::fseek(file_, offsetof(BatchHeader, count), SEEK_SET) == 0 &&
+              std::fwrite(&count_, sizeof(count_), 1, file_) == 1 &&
+              std::fseek(file_, pos, SEEK_SET) == 0;
+    return std::fflush(file_) == 0 && ok;
+}
+
+bool BatchWriter::close() {
+    if (!file_) return true;
+    bool ok = flush();
+    ok = std::fclose(file_) == 0 && ok;
+    file_ = nullptr;
+    return ok;
+}
+
+BatchReader::~BatchReader() {
+    close();
+}
+
+bool BatchReader::open(const std::string& path) {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < BatchFile::kHeaderSize) {
+        ::close(fd);
+        return false;
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    void* map = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) return false;
+
+    BatchHeader h;
+    std::memcpy(&h, map, sizeof(h));
+    if (!validHeader(h)) {
+        ::munmap(map, size);
+        return false;
+    }
+    ::madvise(map, size, MADV_SEQUENTIAL);
+
+    map_ = map;
+    mapSize_ = size;
+    stride_ = strideFor(h.flags);
+    records_ = static_cast<const uint8_t*>(map) + BatchFile::kHeaderSize;
+    uint64_t complete = (size - BatchFile::kHeaderSize) / stride_;
+    count_ = h.count < complete ? h.count : complete;
+    return true;
+}
+
+void BatchReader::close() {
+    if (map_) ::munmap(map_, mapSize_);
+    map_ = nullptr;
+    mapSize_ = 0;
+    records_ = nullptr;
+    stride_ = BatchFile::kStateSize;
+    count_ = 0;
+}
+
+bool BatchReader::solution(uint64_t i, std::vector<Move>& out) const {
+    out.clear();
+    if (!hasSolutions()) return true;
+    const uint8_t* slot = records_ + i * stride_ + BatchFile::kStateSize;
+    if (slot[0] > BatchFile::kMaxSolution) return false;
+    for (size_t k = 0; k < slot[0]; k++) {
+        if (slot[1 + k] >= static_cast<uint8_t>(Move::COUNT)) return false;
+        out.push_back(static_cast<Move>(slot[1 + k]));
+    }
+    return true;
+}
@@ -0,0 +1,105 @@
+#pragma once
+#include "cube.h"
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Binary container for large state batches.
+//
+// Layout (host byte order; the byte-order mark rejects files from a host of the other
+// endianness): a 32-byte header, then fixed-size records. Each record is a
+// 16-byte PackedCube, followed by a 32-byte solution slot when the file has solutions
+// (length byte, then up to kMaxSolution Move values). Records stay 16-byte aligned, so the
+// reader hands out states straight from the mapped file.
+//
+//   offset 0   char[8]  magic "RUBCSBAT"
+//   offset 8   uint32   version (2)
+//   offset 12  uint32   flags (bit 0: solution slots present)
+//   offset 16  uint64   committed record count
+//   offset 24  uint64   byte-order mark 0x0102030405060708
+struct BatchHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t flags;
+    uint64_t count;
+    uint64_t byteOrder;
+};
+
+class BatchFile {
+public:
+    static constexpr uint32_t kVersion = 2;
+    static constexpr uint64_t kByteOrderMark = 0x0102030405060708ull;
+    static constexpr uint32_t kFlagSolutions = 1;
+    static constexpr size_t kHeaderSize = 32;
+    static constexpr size_t kStateSize = 16;
+    static constexpr size_t kSolutionSlot = 32;
+    static constexpr size_t kMaxSolution = kSolutionSlot - 1;
+};
+
+static_assert(sizeof(BatchHeader) == BatchFile::kHeaderSize, "batch header must stay 32 bytes");
+
+// Creates a batch file or appends to an existing one with the same layout. Records are
+// committed when flush() or close() rewrites the header count; records past the count (from
+// a writer that died first) are ignored by readers and overwritten by the next append.
+class BatchWriter {
+public:
+    BatchWriter() = default;
+    ~BatchWriter();
+    BatchWriter(const BatchWriter&) = delete;
+    BatchWriter& operator=(const BatchWriter&) = delete;
+
+    // False if the file cannot be opened or exists with another version or layout.
+    bool open(const std::string& path, bool withSolutions);
+    // `solution` is only stored when the file has solution slots; longer than kMaxSolution
+    // or holding a value that is not a Move fails. States must be solvable (see CubieCube::pack).
+    bool append(const PackedCube& state, const std::vector<Move>& solution = {});
+    bool append(const Cube& cube, const std::vector<Move>& solution = {});
+    bool flush();
+    bool close();
+
+    bool isOpen() const { return file_ != nullptr; }
+    uint64_t count() const { return count_; }
+
+private:
+    std::FILE* file_ = nullptr;
+    bool withSolutions_ = false;
+    uint64_t count_ = 0;
+};
+
+// Read-only view of a batch file through mmap: opening costs no parsing or copying, and
+// state(i) is a reference into the page cache.
+class BatchReader {
+public:
+    BatchReader() = default;
+    ~BatchReader();
+    BatchReader(const BatchReader&) = delete;
+    BatchReader& operator=(const BatchReader&) = delete;
+
+    // False if the file is missing, too short, or has a bad magic/version/byte order.
+    bool open(const std::string& path);
+    void close();
+
+    uint64_t size() const { return count_; }
+    bool hasSolutions() const { return stride_ != BatchFile::kStateSize; }
+
+    // Raw record; it comes from a file, so it may not decode to a valid CubieCube.
+    const PackedCube& state(uint64_t i) const {
+        return *reinterpret_cast<const PackedCube*>(records_ + i * stride_);
+    }
+    // Decoded record; false (leaving `out` unspecified) when it is not a valid CubieCube.
+    bool state(uint64_t i, CubieCube& out) const {
+        out = CubieCube::unpack(state(i));
+        return out.isValid();
+    }
+    // Stored solution, empty when the file has no solution slots; false (leaving `out`
+    // unspecified) when the stored length or a stored byte is out of range.
+    bool solution(uint64_t i, std::vector<Move>& out) const;
+
+private:
+    void* map_ = nullptr;
+    size_t mapSize_ = 0;
+    const uint8_t* records_ = nullptr;
+    size_t stride_ = BatchFile::kStateSize;
+    uint64_t count_ = 0;
+};
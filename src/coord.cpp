@@ -0,0 +1,54 @@
+#include "coord.h"
+
+namespace {
+template <typename Get, typename Set>
+std::vector<uint16_t> buildTable(int size, Get get, Set set) {
+    std::vector<uint16_t> table(static_cast<size_t>(size) * CoordTables::kMoves);
+    CubieCube c;
+    for (int i = 0; i < size; i++) {
+        for (int m = 0; m < CoordTables::kMoves; m++) {
+            CubieCube next = c;
+            set(next, i);
+            next.applyMove(static_cast<Move>(m));
+            table[static_cast<size_t>(i) * CoordTables::kMoves + m] = static_cast<uint16_t>(get(next));
+        }
+    }
+    return table;
+}
+}
+
+bool CoordTables::isG1Move(Move m) {
+    int idx = static_cast<int>(m);
+    int face = idx / 3;
+    return face == FACE_U || face == FACE_D || idx % 3 == 2;
+}
+
+CoordTables::CoordTables() {
+    twistMove = buildTable(kTwist, [](const CubieCube& c) { return c.twist(); },
+                           [](CubieCube& c, int v) { c.setTwist(v); });
+    flipMove = buildTable(kFlip, [](const CubieCube& c) { return c.flip(); },
+                          [](CubieCube& c, int v) { c.setFlip(v); });
+    sliceMove = buildTable(kSlice, [](const CubieCube& c) { return c.slice(); },
+                           [](CubieCube& c, int v) { c.setSlice(v); });
+    sliceSortedMove = buildTable(kSliceSorted, [](const CubieCube& c) { return c.sliceSorted(); },
+                                 [](CubieCube& c, int v) { c.setSliceSorted(v); });
+    cornerPermMove = buildTable(kCornerPerm, [](const CubieCube& c) { return c.cornerPerm(); },
+                                [](CubieCube& c, int v) { c.setCornerPerm(v); });
+
+    udEdgesMove.assign(static_cast<size_t>(kUdEdges) * kMoves, kInvalid);
+    for (int i = 0; i < kUdEdges; i++) {
+        CubieCube c;
+        c.setUdEdges(i);
+        for (int m = 0; m < kMoves; m++) {
+            if (!isG1Move(static_cast<Move>(m))) continue;
+            CubieCube next = c;
+            next.applyMove(static_cast<Move>(m));
+            udEdgesMove[static_cast<size_t>(i) * kMoves + m] = static_cast<uint16_t>(next.udEdges());
+        }
+    }
+}
+
+const CoordTables& CoordTables::get() {
+    static const CoordTables tables;
+    return tables;
+}
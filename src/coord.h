@@ -0,0 +1,35 @@
+#pragma once
+#include "cube.h"
+#include <cstdint>
+#include <vector>
+
+// Per-move transition tables for the CubieCube coordinates, so search code can move
+// between states with a single lookup: next = table[coord * kMoves + move].
+struct CoordTables {
+    static constexpr int kMoves = kFaceMoves;
+    static constexpr int kTwist = 2187;
+    static constexpr int kFlip = 2048;
+    static constexpr int kSlice = 495;
+    static constexpr int kSliceSorted = 11880;
+    static constexpr int kCornerPerm = 40320;
+    static constexpr int kUdEdges = 40320;
+
+    // Marks udEdges transitions for moves that leave G1 (the coordinate is undefined there).
+    static constexpr uint16_t kInvalid = 0xFFFF;
+
+    std::vector<uint16_t> twistMove;
+    std::vector<uint16_t> flipMove;
+    std::vector<uint16_t> sliceMove;
+    std::vector<uint16_t> sliceSortedMove;
+    std::vector<uint16_t> cornerPermMove;
+    std::vector<uint16_t> udEdgesMove;  // only U, D and half turns of L, R, F, B
+
+    // Built on first use (thread-safe) and shared read-only afterwards.
+    static const CoordTables& get();
+
+    // Moves that keep a G1 state (oriented pieces, slice edges in the slice) inside G1.
+    static bool isG1Move(Move m);
+
+private:
+    CoordTables();
+};
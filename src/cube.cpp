@@ -1,4 +1,7 @@
 #include "cube.h"
+#include "basic_cube.h"
+#include "facelet_gather.h"
+#include "random_state.h"
 #include <algorithm>
 #include <cassert>
 #include <chrono>
@@ -11,185 +14,287 @@
 
 #define I(face, pos) ((face) * 9 + (pos))
 
-Cube::Cube() {
+namespace {
+// The sticker model lives in NxnGeometry (basic_cube.h); the 3x3 tables are its N = 3 case,
+// generated at compile time.
+using Geometry = NxnGeometry<3>;
+
+// Where sticker `index` ends up after move `m`.
+constexpr int stickerTarget(int index, Move m) {
+    return Geometry::stickerTarget(index, Geometry::moveTurn(m));
+}
+
+using MoveTables = std::array<std::array<uint8_t, 54>, static_cast<int>(Move::COUNT)>;
+
+// Gather form: after move m, facelet i holds the sticker previously at kMoveTables[m][i].
+constexpr MoveTables kMoveTables = Geometry::buildNamedTables();
+
+constexpr bool isPermutation(const std::array<uint8_t, 54>& perm) {
+    bool seen[54] = {};
+    for (uint8_t p : perm) {
+        if (p >= 54 || seen[p]) return false;
+        seen[p] = true;
+    }
+    return true;
+}
+
+constexpr bool allPermutations(const MoveTables& tables) {
+    for (const auto& t : tables) {
+        if (!isPermutation(t)) return false;
+    }
+    return true;
+}
+
+static_assert(allPermutations(kMoveTables), "every move table must be a facelet permutation");
+
+const FaceletGather& moveGather(Move m) {
+    static const auto gathers = [] {
+        std::array<FaceletGather, static_cast<int>(Move::COUNT)> g;
+        for (size_t i = 0; i < g.size(); i++) g[i] = FaceletGather(kMoveTables[i]);
+        return g;
+    }();
+    return gathers[static_cast<int>(m)];
+}
+
+// Broadcasts each face's centre over the face: solved iff the gather is a no-op.
+const FaceletGather& centreGather() {
+    static const FaceletGather gather = [] {
+        std::array<uint8_t, 54> index{};
+        for (int i = 0; i < 54; i++) index[i] = static_cast<uint8_t>(I(i / 9, 4));
+        return FaceletGather(index);
+    }();
+    return gather;
+}
+
+// Facelets a move actually relocates; only these can change their misplaced bit.
+struct MoveTouch {
+    uint64_t mask = 0;
+    uint8_t count = 0;
+    uint8_t index[54] = {};
+};
+
+constexpr std::array<MoveTouch, static_cast<int>(Move::COUNT)> buildMoveTouch() {
+    std::array<MoveTouch, static_cast<int>(Move::COUNT)> out{};
+    for (int m = 0; m < static_cast<int>(Move::COUNT); m++) {
+        for (int i = 0; i < 54; i++) {
+            if (kMoveTables[m][i] == i) continue;
+            out[m].mask |= uint64_t(1) << i;
+            out[m].index[out[m].count++] = static_cast<uint8_t>(i);
+        }
+    }
+    return out;
+}
+
+constexpr auto kMoveTouch = buildMoveTouch();
+
+// Zobrist keys: one random word per (facelet, colour). Colours are masked to 3 bits so
+// out-of-range values written through setState still index inside the table.
+constexpr uint64_t splitmix64(uint64_t& x) {
+    uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+constexpr std::array<std::array<uint64_t, 8>, 54> buildZobrist() {
+    std::array<std::array<uint64_t, 8>, 54> out{};
+    uint64_t seed = 0x5275626373436275ull;
+    for (auto& facelet : out)
+        for (auto& key : facelet) key = splitmix64(seed);
+    return out;
+}
+
+constexpr auto kZobrist = buildZobrist();
+
+inline uint64_t zobrist(int i, Color c) {
+    return kZobrist[i][static_cast<uint8_t>(c) & 7];
+}
+
+const uint8_t* bytes(const std::array<Color, 54>& state) {
+    return reinterpret_cast<const uint8_t*>(state.data());
+}
+
+uint8_t* bytes(std::array<Color, 54>& state) {
+    return reinterpret_cast<uint8_t*>(state.data());
+}
+}
+
+Cube::BasicCube() {
     reset();
 }
 
 int Cube::faceletIndexFor(int face, int x, int y, int z) {
-    int row = 0, col = 0;
-    switch (face) {
-    case FACE_U:
-        if (y != 1) return -1;
-        row = z + 1;
-        col = x + 1;
-        break;
-    case FACE_D:
-        if (y != -1) return -1;
-        row = 1 - z;
-        col = x + 1;
-        break;
-    case FACE_L:
-        if (x != -1) return -1;
-        row = 1 - y;
-        col = z + 1;
-        break;
-    case FACE_R:
-        if (x != 1) return -1;
-        row = 1 - y;
-        col = 1 - z;
-        break;
-    case FACE_F:
-        if (z != 1) return -1;
-        row = 1 - y;
-        col = x + 1;
-        break;
-    case FACE_B:
-        if (z != -1) return -1;
-        row = 1 - y;
-        col = 1 - x;
-        break;
-    default:
-        return -1;
-    }
-
-    if (row < 0 || row > 2 || col < 0 || col > 2) return -1;
-    return row * 3 + col;
+    return Geometry::facePosition(face, 2 * x, 2 * y, 2 * z);
 }
 
-void Cube::reset() {
-    // Map face indices (U,D,L,R,F,B) to standard cube colors.
-    // This must stay consistent with the solver's corner/edge color definitions.
-    static constexpr Color kFaceColor[6] = {
-        Color::White,   // U
-        Color::Yellow,  // D
-        Color::Green,   // L
-        Color::Blue,    // R
-        Color::Red,     // F
-        Color::Orange,  // B
-    };
+namespace {
+bool standardCentres(const std::array<Color, 54>& f) {
+    unsigned diff = 0;
+    for (int face = 0; face < 6; face++) {
+        diff |= static_cast<unsigned>(f[I(face, 4)]) ^ static_cast<unsigned>(kFaceColor[face]);
+    }
+    return diff == 0;
+}
+
+// The 24 centre arrangements reachable by whole-cube rotations, generated from x and y.
+bool rotatedCentres(const std::array<Color, 54>& f) {
+    using Centres = std::array<Color, 6>;
+    static const std::vector<Centres> reachable = [] {
+        std::vector<Centres> out;
+        out.push_back({kFaceColor[0], kFaceColor[1], kFaceColor[2], kFaceColor[3], kFaceColor[4], kFaceColor[5]});
+        for (size_t i = 0; i < out.size(); i++) {
+            for (Move m : {Move::x, Move::y}) {
+                Centres next;
+                const auto& perm = kMoveTables[static_cast<int>(m)];
+                for (int face = 0; face < 6; face++) next[face] = out[i][perm[I(face, 4)] / 9];
+                if (std::find(out.begin(), out.end(), next) == out.end()) out.push_back(next);
+            }
+        }
+        return out;
+    }();
+    Centres centres;
+    for (int face = 0; face < 6; face++) centres[face] = f[I(face, 4)];
+    return std::find(reachable.begin(), reachable.end(), centres) != reachable.end();
+}
+}
 
+void Cube::reset() {
     for (int f = 0; f < 6; f++) {
         for (int i = 0; i < 9; i++) {
             state_[f * 9 + i] = kFaceColor[f];
         }
     }
+    stateChanged();
 }
 
 void Cube::setState(const std::array<Color, 54>& s) {
     state_ = s;
+    stateChanged();
 }
 
-void Cube::applyMove(Move m) {
-    applyMoveRaw(m);
+void Cube::stateChanged() {
+    cubiesValid_ = false;
+    centreGather().apply(bytes(state_), bytes(centres_));
+    misplaced_ = FaceletGather::mismatchMask(bytes(state_), bytes(centres_));
+    hash_ = hashFromScratch(state_);
 }
 
-namespace {
-struct Vec3i {
-    int x = 0;
-    int y = 0;
-    int z = 0;
-};
-
-struct Sticker {
-    Vec3i pos;
-    int dir = FACE_U;
-};
+uint64_t Cube::hashFromScratch(const std::array<Color, 54>& state) {
+    uint64_t h = 0;
+    for (int i = 0; i < 54; i++) h ^= zobrist(i, state[i]);
+    return h;
+}
 
-static Vec3i dirVec(int dir) {
-    static constexpr Vec3i v[6] = {
-        {0, 1, 0}, {0, -1, 0}, {-1, 0, 0}, {1, 0, 0}, {0, 0, 1}, {0, 0, -1}
-    };
-    return v[dir];
+void Cube::updateMisplaced(Move m) {
+    // Face turns never move centres, so centres_ stays valid and only the relocated
+    // facelets can change state.
+    if (FaceletGather::simdEnabled()) {
+        misplaced_ = FaceletGather::mismatchMask(bytes(state_), bytes(centres_));
+        return;
+    }
+    const MoveTouch& touch = kMoveTouch[static_cast<int>(m)];
+    uint64_t mask = misplaced_ & ~touch.mask;
+    for (int k = 0; k < touch.count; k++) {
+        int i = touch.index[k];
+        mask |= static_cast<uint64_t>(state_[i] != centres_[i]) << i;
+    }
+    misplaced_ = mask;
 }
 
-static int vecDir(const Vec3i& v) {
-    if (v.y == 1) return FACE_U;
-    if (v.y == -1) return FACE_D;
-    if (v.x == -1) return FACE_L;
-    if (v.x == 1) return FACE_R;
-    if (v.z == 1) return FACE_F;
-    return FACE_B;
+int Cube::misplacedCount() const {
+    return __builtin_popcountll(misplaced_);
 }
 
-static Vec3i rot90(Vec3i v, int axis, int sign) {
-    if (axis == 0) return sign > 0 ? Vec3i{v.x, -v.z, v.y} : Vec3i{v.x, v.z, -v.y};
-    if (axis == 1) return sign > 0 ? Vec3i{v.z, v.y, -v.x} : Vec3i{-v.z, v.y, v.x};
-    return sign > 0 ? Vec3i{-v.y, v.x, v.z} : Vec3i{v.y, -v.x, v.z};
+const CubieCube& Cube::cubies() const {
+    if (!cubiesValid_) {
+        CubieCube::fromFacelets(state_, cubies_);
+        cubiesValid_ = true;
+    }
+    return cubies_;
 }
 
-static Sticker stickerAt(int index) {
-    int face = index / 9;
-    int pos = index % 9;
-    int row = pos / 3;
-    int col = pos % 3;
-    Sticker s;
-    s.dir = face;
-    if (face == FACE_U) s.pos = {col - 1, 1, row - 1};
-    else if (face == FACE_D) s.pos = {col - 1, -1, 1 - row};
-    else if (face == FACE_L) s.pos = {-1, 1 - row, col - 1};
-    else if (face == FACE_R) s.pos = {1, 1 - row, 1 - col};
-    else if (face == FACE_F) s.pos = {col - 1, 1 - row, 1};
-    else s.pos = {1 - col, 1 - row, -1};
-    return s;
+void Cube::setCubies(const CubieCube& c) {
+    state_ = c.toFacelets();
+    stateChanged();
+    cubies_ = c;
+    cubiesValid_ = true;
 }
 
-static int stickerIndex(const Sticker& s) {
-    int pos = Cube::faceletIndexFor(s.dir, s.pos.x, s.pos.y, s.pos.z);
-    return s.dir * 9 + pos;
+void Cube::applyMove(Move m) {
+    if (m == Move::COUNT) return;
+    if (!isFaceMove(m)) {
+        // Slice, wide and rotation moves carry centres along, changing every facelet's
+        // reference colour: refresh the derived state in full.
+        moveGather(m).apply(bytes(state_), bytes(state_));
+        stateChanged();
+        return;
+    }
+
+    // Only relocated facelets change colour, so the hash moves by their old and new keys.
+    const MoveTouch& touch = kMoveTouch[static_cast<int>(m)];
+    uint64_t h = hash_;
+    for (int k = 0; k < touch.count; k++) h ^= zobrist(touch.index[k], state_[touch.index[k]]);
+    moveGather(m).apply(bytes(state_), bytes(state_));
+    for (int k = 0; k < touch.count; k++) h ^= zobrist(touch.index[k], state_[touch.index[k]]);
+    hash_ = h;
+    updateMisplaced(m);
+    cubiesValid_ = false;
 }
 
-static int coord(const Vec3i& v, int axis) {
-    return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+void Cube::applyMove(int move) {
+    if (move < 0 || move >= kMoves) return;
+    if (move < 18) {
+        applyMove(static_cast<Move>(move));
+        return;
+    }
+    // Inner and far layers are off the hot path: a plain gather, then a full refresh.
+    const auto& perm = kNxnMoveTables<3>[move];
+    std::array<Color, 54> next;
+    for (int i = 0; i < 54; i++) next[i] = state_[perm[i]];
+    state_ = next;
+    stateChanged();
 }
 
-static void moveShape(Move m, int& axis, int& layer, int& turns) {
-    static constexpr int axes[6] = {1, 1, 0, 0, 2, 2};
-    static constexpr int layers[6] = {1, -1, -1, 1, 1, -1};
-    static constexpr int cw[6] = {-1, 1, 1, -1, -1, 1};
-    int i = static_cast<int>(m);
-    int face = i / 3;
-    int type = i % 3;
-    axis = axes[face];
-    layer = layers[face];
-    turns = type == 2 ? 2 : (type == 0 ? cw[face] : -cw[face]);
+void Cube::applyMoves(const Move* moves, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        if (moves[i] == Move::COUNT) continue;
+        moveGather(moves[i]).apply(bytes(state_), bytes(state_));
+    }
+    stateChanged();
 }
+
+void Cube::applyGather(const FaceletGather& gather) {
+    gather.apply(bytes(state_), bytes(state_));
+    stateChanged();
 }
 
-void Cube::applyMoveRaw(Move m) {
+void Cube::applyMoveReference(Move m) {
     if (m == Move::COUNT) return;
 
-    int axis = 0, layer = 0, turns = 0;
-    moveShape(m, axis, layer, turns);
-    int sign = turns < 0 ? -1 : 1;
-    int reps = turns < 0 ? -turns : turns;
-
     std::array<Color, 54> next = state_;
     bool written[54] = {};
     for (int i = 0; i < 54; i++) {
-        Sticker s = stickerAt(i);
-        if (coord(s.pos, axis) == layer) {
-            for (int j = 0; j < reps; j++) {
-                s.pos = rot90(s.pos, axis, sign);
-                s.dir = vecDir(rot90(dirVec(s.dir), axis, sign));
-            }
-        }
-        int out = stickerIndex(s);
+        int out = stickerTarget(i, m);
         assert(out >= 0 && out < 54);
         next[out] = state_[i];
         written[out] = true;
     }
     for (bool ok : written) assert(ok);
     state_ = next;
+    stateChanged();
+}
+
+const std::array<uint8_t, 54>& Cube::movePermutation(Move m) {
+    return kMoveTables[static_cast<int>(m)];
 }
 
 void Cube::scramble(int numMoves) {
-    auto seed = std::chrono::steady_clock::now().time_since_epoch().count();
-    std::mt19937 rng(seed);
-    // Only use quarter/half turns of the 6 faces = 18 moves
-    std::uniform_int_distribution<int> dist(0, 17);
-    for (int i = 0; i < numMoves; i++) {
-        applyMove(static_cast<Move>(dist(rng)));
-    }
+    scramble(numMoves, static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count()));
+}
+
+void Cube::scramble(int numMoves, uint64_t seed) {
+    Rng rng(seed);
+    applyMoves(Scrambler::generate(rng, numMoves));
 
     // Scrambling via legal moves should always remain solvable; keep a guard anyway.
 #ifndef NDEBUG
@@ -199,75 +304,111 @@ void Cube::scramble(int numMoves) {
 #endif
 }
 
-bool Cube::isSolved() const {
-    for (int f = 0; f < 6; f++) {
-        Color center = state_[f * 9 + 4];
-        for (int i = 0; i < 9; i++) {
-            if (state_[f * 9 + i] != center) return false;
-        }
-    }
-    return true;
+
+bool Cube::operator==(const Cube& other) const {
+    if (hash_ != other.hash_) return false;
+    return FaceletGather::equal(bytes(state_), bytes(other.state_));
 }
 
 bool Cube::isSolvable() const {
-    // Basic color count check (necessary but not sufficient).
+    return checkSolvable() == Solvability::Solvable;
+}
+
+namespace {
+// Parity of the set bits of a 12-bit mask.
+unsigned bitParity(unsigned v) {
+    v ^= v >> 8;
+    v ^= v >> 4;
+    return (0x6996u >> (v & 0xFu)) & 1u;
+}
+}
+
+// Colour-level reasons, only consulted once the cubie checks have failed: with standard
+// centres and all 20 cubies identified and distinct, every colour already appears 9 times.
+Solvability Cube::colorCountProblem() const {
     int counts[6] = {};
     for (Color c : state_) {
         int idx = static_cast<int>(c);
-        if (idx < 0 || idx >= 6) return false;
+        if (idx >= 6) return Solvability::BadColor;
         counts[idx]++;
     }
     for (int i = 0; i < 6; i++) {
-        if (counts[i] != 9) return false;
+        if (counts[i] != 9) return Solvability::BadColorCount;
     }
+    return Solvability::Solvable;
+}
 
-    // Corner/edge permutation + orientation constraints.
-    bool seenCorner[8] = {};
-    bool seenEdge[12] = {};
-
-    int cornerPerm[8];
-    int edgePerm[12];
-
-    int coSum = 0;
-    int eoSum = 0;
+Solvability Cube::checkSolvable() const {
+    // Any whole-cube orientation of the standard scheme is fine; cubies() reads colours
+    // relative to the centres.
+    if (!standardCentres(state_) && !rotatedCentres(state_)) {
+        Solvability colors = colorCountProblem();
+        return colors != Solvability::Solvable ? colors : Solvability::BadCentres;
+    }
 
+    // Corner/edge permutation + orientation constraints, with permutation parity computed
+    // in the same pass. Parity is tracked as the parity of the inversion count: each element
+    // adds the number of larger elements already seen, i.e. bitParity(seen >> p). This is
+    // branch-free, unlike walking cycles, which mispredicts on random states.
+    const CubieCube& c = cubies();
+    unsigned seenCorner = 0;
+    unsigned cornerParity = 0;
+    unsigned anyUnknown = 0;
+    unsigned coSum = 0;
     for (int i = 0; i < 8; i++) {
-        int cp = getCornerPermutation(i);
-        int co = getCornerOrientation(i);
-        if (cp < 0 || cp >= 8) return false;
-        if (co < 0 || co >= 3) return false;
-        if (seenCorner[cp]) return false;
-        seenCorner[cp] = true;
-        cornerPerm[i] = cp;
-        coSum = (coSum + co) % 3;
+        unsigned p = c.cp[i] & 7u;
+        cornerParity ^= bitParity(seenCorner >> p);
+        seenCorner |= 1u << p;
+        anyUnknown |= c.cp[i];
+        coSum += c.co[i];
     }
-    if (coSum != 0) return false;
-
+    unsigned seenEdge = 0;
+    unsigned edgeParity = 0;
+    unsigned eoSum = 0;
     for (int i = 0; i < 12; i++) {
-        int ep = getEdgePermutation(i);
-        int eo = getEdgeOrientation(i);
-        if (ep < 0 || ep >= 12) return false;
-        if (!(eo == 0 || eo == 1)) return false;
-        if (seenEdge[ep]) return false;
-        seenEdge[ep] = true;
-        edgePerm[i] = ep;
-        eoSum = (eoSum + eo) % 2;
+        unsigned p = c.ep[i] & 15u;
+        edgeParity ^= bitParity(seenEdge >> p);
+        seenEdge |= 1u << p;
+        anyUnknown |= c.ep[i];
+        eoSum += c.eo[i];
     }
-    if (eoSum != 0) return false;
 
-    // Permutation parity: corners and edges must have the same parity.
-    auto parity = [](const int* p, int n) -> int {
-        int inv = 0;
-        for (int i = 0; i < n; i++) {
-            for (int j = i + 1; j < n; j++) {
-                if (p[i] > p[j]) inv++;
-            }
+    // kUnknown has the high bit set; real cubie ids never do.
+    if ((anyUnknown & 0x80u) || seenCorner != 0xFFu || seenEdge != 0xFFFu) {
+        Solvability colors = colorCountProblem();
+        if (colors != Solvability::Solvable) return colors;
+        for (int i = 0; i < 8; i++) {
+            if (c.cp[i] == CubieCube::kUnknown) return Solvability::UnknownCorner;
         }
-        return inv & 1;
-    };
-    if (parity(cornerPerm, 8) != parity(edgePerm, 12)) return false;
+        for (int i = 0; i < 12; i++) {
+            if (c.ep[i] == CubieCube::kUnknown) return Solvability::UnknownEdge;
+        }
+        return seenCorner != 0xFFu ? Solvability::DuplicateCorner : Solvability::DuplicateEdge;
+    }
+    if (coSum % 3 != 0) return Solvability::CornerTwist;
+    if (eoSum % 2 != 0) return Solvability::EdgeFlip;
 
-    return true;
+    // Permutation parity: corners and edges must have the same parity.
+    if (cornerParity != edgeParity) return Solvability::Parity;
+
+    return Solvability::Solvable;
+}
+
+const char* Cube::solvabilityName(Solvability s) {
+    switch (s) {
+    case Solvability::Solvable: return "solvable";
+    case Solvability::BadColor: return "invalid colour value";
+    case Solvability::BadColorCount: return "colour does not appear exactly 9 times";
+    case Solvability::BadCentres: return "centres are not an orientation of the colour scheme";
+    case Solvability::UnknownCorner: return "corner with impossible colours";
+    case Solvability::UnknownEdge: return "edge with impossible colours";
+    case Solvability::DuplicateCorner: return "corner appears twice";
+    case Solvability::DuplicateEdge: return "edge appears twice";
+    case Solvability::CornerTwist: return "twisted corner";
+    case Solvability::EdgeFlip: return "flipped edge";
+    case Solvability::Parity: return "corner/edge permutation parity mismatch";
+    }
+    return "unknown";
 }
 
 Move Cube::inverseMove(Move m) {
@@ -283,11 +424,24 @@ std::string Cube::moveToString(Move m) {
     static const char* names[] = {
         "U", "U'", "U2", "D", "D'", "D2",
         "L", "L'", "L2", "R", "R'", "R2",
-        "F", "F'", "F2", "B", "B'", "B2"
+        "F", "F'", "F2", "B", "B'", "B2",
+        "M", "M'", "M2", "E", "E'", "E2",
+        "S", "S'", "S2", "u", "u'", "u2",
+        "d", "d'", "d2", "l", "l'", "l2",
+        "r", "r'", "r2", "f", "f'", "f2",
+        "b", "b'", "b2", "x", "x'", "x2",
+        "y", "y'", "y2", "z", "z'", "z2"
     };
+    static_assert(sizeof(names) / sizeof(names[0]) == static_cast<int>(Move::COUNT), "one name per move");
     return names[static_cast<int>(m)];
 }
 
+std::string Cube::moveToString(int move) {
+    std::string name = moveToString(static_cast<Move>(move % 18));
+    int depth = move / 18;
+    return depth == 0 ? name : std::to_string(depth + 1) + name;
+}
+
 const char* Cube::colorName(Color c) {
     static const char* names[] = {"White", "Yellow", "Red", "Orange", "Green", "Blue"};
     return names[static_cast<int>(c)];
@@ -312,7 +466,7 @@ static const int cornerFacelets[8][3] = {
 };
 
 // The colors that each corner should have (matching the solved state)
-static const Color cornerColors[8][3] = {
+static constexpr Color cornerColors[8][3] = {
     {Color::White,  Color::Blue,   Color::Red},    // URF
     {Color::White,  Color::Red,    Color::Green},   // UFL
     {Color::White,  Color::Green,  Color::Orange},  // ULB
@@ -339,7 +493,7 @@ static const int edgeFacelets[12][2] = {
     {I(FACE_B,3), I(FACE_R,5)},  // BR
 };
 
-static const Color edgeColors[12][2] = {
+static constexpr Color edgeColors[12][2] = {
     {Color::White,  Color::Blue},    // UR
     {Color::White,  Color::Red},     // UF
     {Color::White,  Color::Green},   // UL
@@ -355,45 +509,439 @@ static const Color edgeColors[12][2] = {
 };
 
 int Cube::getCornerPermutation(int pos) const {
-    Color c0 = state_[cornerFacelets[pos][0]];
-    Color c1 = state_[cornerFacelets[pos][1]];
-    Color c2 = state_[cornerFacelets[pos][2]];
-    for (int c = 0; c < 8; c++) {
-        if ((c0 == cornerColors[c][0] || c0 == cornerColors[c][1] || c0 == cornerColors[c][2]) &&
-            (c1 == cornerColors[c][0] || c1 == cornerColors[c][1] || c1 == cornerColors[c][2]) &&
-            (c2 == cornerColors[c][0] || c2 == cornerColors[c][1] || c2 == cornerColors[c][2])) {
-            // Make sure all three are different and match
-            if (c0 != c1 && c1 != c2 && c0 != c2)
-                return c;
-        }
-    }
-    return -1; // should not happen on valid cube
+    uint8_t cp = cubies().cp[pos];
+    return cp == CubieCube::kUnknown ? -1 : cp; // -1 should not happen on valid cube
 }
 
 int Cube::getCornerOrientation(int pos) const {
-    Color c0 = state_[cornerFacelets[pos][0]];
-    // Orientation: 0 if U/D color is on U/D face, 1 if CW, 2 if CCW
-    if (c0 == Color::White || c0 == Color::Yellow) return 0;
-    Color c1 = state_[cornerFacelets[pos][1]];
-    if (c1 == Color::White || c1 == Color::Yellow) return 1;
-    return 2;
+    return cubies().co[pos];
 }
 
 int Cube::getEdgePermutation(int pos) const {
-    Color c0 = state_[edgeFacelets[pos][0]];
-    Color c1 = state_[edgeFacelets[pos][1]];
+    uint8_t ep = cubies().ep[pos];
+    return ep == CubieCube::kUnknown ? -1 : ep;
+}
+
+int Cube::getEdgeOrientation(int pos) const {
+    return cubies().eo[pos];
+}
+
+// ============================================================
+// Cubie-level state
+// ============================================================
+
+CubieCube::CubieCube() {
+    for (int i = 0; i < 8; i++) {
+        cp[i] = static_cast<uint8_t>(i);
+        co[i] = 0;
+    }
+    for (int i = 0; i < 12; i++) {
+        ep[i] = static_cast<uint8_t>(i);
+        eo[i] = 0;
+    }
+}
+
+bool CubieCube::operator==(const CubieCube& other) const {
+    return cp == other.cp && co == other.co && ep == other.ep && eo == other.eo;
+}
+
+namespace {
+// Colour value -> 0..5, or kNoColor for values outside the enum (so they never match a cubie).
+constexpr uint8_t kNoColor = 7;
+
+struct ColorIndexTable {
+    uint8_t index[256] = {};
+};
+
+constexpr ColorIndexTable buildColorIndex() {
+    ColorIndexTable t{};
+    for (int i = 0; i < 256; i++) t.index[i] = static_cast<uint8_t>(i < 6 ? i : kNoColor);
+    return t;
+}
+
+constexpr ColorIndexTable kColorIndex = buildColorIndex();
+
+constexpr unsigned colorIndex(Color c) {
+    return kColorIndex.index[static_cast<uint8_t>(c)];
+}
+
+// Cubie identity and orientation by the ordered colour tuple read off a position's facelets
+// (U/D facelet first, then clockwise for corners). Colours take 3 bits each, so a corner is
+// one load from 8^3 entries and an edge from 8^2. Tuples no cubie shows, including a
+// corner's colours in mirrored order, map to kUnknown.
+struct CubieTupleTables {
+    uint8_t corner[512] = {};
+    uint8_t cornerTwist[512] = {};
+    uint8_t edge[64] = {};
+    uint8_t edgeFlip[64] = {};
+};
+
+constexpr CubieTupleTables buildTupleTables() {
+    CubieTupleTables t{};
+    for (int i = 0; i < 512; i++) t.corner[i] = CubieCube::kUnknown;
+    for (int i = 0; i < 64; i++) t.edge[i] = CubieCube::kUnknown;
+    for (int c = 0; c < 8; c++) {
+        for (int o = 0; o < 3; o++) {
+            // Twist o puts sticker k of the cubie on facelet (k + o) % 3 (see toFacelets).
+            unsigned key = 0;
+            for (int j = 0; j < 3; j++) key = key * 8 + colorIndex(cornerColors[c][(j + 3 - o) % 3]);
+            t.corner[key] = static_cast<uint8_t>(c);
+            t.cornerTwist[key] = static_cast<uint8_t>(o);
+        }
+    }
     for (int e = 0; e < 12; e++) {
-        if ((c0 == edgeColors[e][0] && c1 == edgeColors[e][1]) ||
-            (c0 == edgeColors[e][1] && c1 == edgeColors[e][0])) {
-            return e;
+        for (int o = 0; o < 2; o++) {
+            unsigned key = colorIndex(edgeColors[e][o]) * 8 + colorIndex(edgeColors[e][1 - o]);
+            t.edge[key] = static_cast<uint8_t>(e);
+            t.edgeFlip[key] = static_cast<uint8_t>(o);
         }
     }
-    return -1;
+    return t;
 }
 
-int Cube::getEdgeOrientation(int pos) const {
-    Color c0 = state_[edgeFacelets[pos][0]];
-    int ep = getEdgePermutation(pos);
-    if (ep < 0) return 0;
-    return (c0 == edgeColors[ep][0]) ? 0 : 1;
+constexpr CubieTupleTables kCubieByTuple = buildTupleTables();
+
+// `index` maps a facelet colour to the standard-scheme colour index it stands for.
+template <typename ColorIndex>
+bool decodeCubies(const std::array<Color, 54>& f, ColorIndex index, CubieCube& out) {
+    // Built in a local: byte stores through `out` could alias `f` and force reloads.
+    CubieCube c;
+    unsigned unknown = 0;
+    for (int pos = 0; pos < 8; pos++) {
+        unsigned key = index(f[cornerFacelets[pos][0]]) << 6 | index(f[cornerFacelets[pos][1]]) << 3 |
+                       index(f[cornerFacelets[pos][2]]);
+        c.cp[pos] = kCubieByTuple.corner[key];
+        c.co[pos] = kCubieByTuple.cornerTwist[key];
+        unknown |= c.cp[pos];
+    }
+
+    for (int pos = 0; pos < 12; pos++) {
+        unsigned key = index(f[edgeFacelets[pos][0]]) << 3 | index(f[edgeFacelets[pos][1]]);
+        c.ep[pos] = kCubieByTuple.edge[key];
+        c.eo[pos] = kCubieByTuple.edgeFlip[key];
+        unknown |= c.ep[pos];
+    }
+    out = c;
+    return (unknown & 0x80u) == 0;  // kUnknown has the high bit set; cubie ids never do
+}
+
+}
+
+bool CubieCube::fromFacelets(const std::array<Color, 54>& f, CubieCube& out) {
+    if (standardCentres(f)) return decodeCubies(f, colorIndex, out);
+
+    // Reoriented cube (slice/wide moves, rotations): read colours relative to the centres,
+    // so cubie form never depends on how the cube as a whole is held.
+    uint8_t remap[8];
+    for (auto& r : remap) r = kNoColor;
+    for (int face = 0; face < 6; face++) {
+        remap[colorIndex(f[I(face, 4)])] = static_cast<uint8_t>(colorIndex(kFaceColor[face]));
+    }
+    remap[kNoColor] = kNoColor;
+    return decodeCubies(f, [&remap](Color c) { return unsigned(remap[colorIndex(c)]); }, out);
+}
+
+std::array<Color, 54> CubieCube::toFacelets() const {
+    std::array<Color, 54> f{};
+    for (int i = 0; i < 54; i++) f[i] = kFaceColor[i / 9];
+    for (int pos = 0; pos < 8; pos++) {
+        for (int k = 0; k < 3; k++) {
+            f[cornerFacelets[pos][(k + co[pos]) % 3]] = cornerColors[cp[pos]][k];
+        }
+    }
+    for (int pos = 0; pos < 12; pos++) {
+        for (int k = 0; k < 2; k++) {
+            f[edgeFacelets[pos][(k + eo[pos]) % 2]] = edgeColors[ep[pos]][k];
+        }
+    }
+    return f;
+}
+
+namespace {
+// Cubie form of each move, read off the facelet tables applied to a solved cube. A move
+// that carries the centres along is `after` read with fixed colours, and re-expressing the
+// state relative to the moved centres is a further left multiply by `before`
+// (identity for face moves).
+struct CubieMove {
+    CubieCube before;
+    CubieCube after;
+};
+
+const CubieMove& moveCubie(Move m) {
+    static const auto cubes = [] {
+        std::array<CubieMove, static_cast<int>(Move::COUNT)> out;
+        for (size_t i = 0; i < out.size(); i++) {
+            Cube c;
+            c.applyMove(static_cast<Move>(i));
+            CubieCube relative;
+            CubieCube::fromFacelets(c.getState(), relative);
+            decodeCubies(c.getState(), colorIndex, out[i].after);
+            out[i].before = relative * out[i].after.inverse();
+        }
+        return out;
+    }();
+    return cubes[static_cast<int>(m)];
+}
+}
+
+void CubieCube::applyMove(Move m) {
+    if (m == Move::COUNT) return;
+    const CubieMove& move = moveCubie(m);
+    if (isFaceMove(m)) {
+        *this = *this * move.after;
+    } else {
+        *this = move.before * *this * move.after;
+    }
+}
+
+namespace {
+// Corner orientation composition. Values 3..5 mark corners of mirrored cubes (reflection
+// symmetries); for ordinary states this is just (a + b) % 3.
+constexpr uint8_t kCornerOriMul[6][6] = {
+    {0, 1, 2, 3, 4, 5},
+    {1, 2, 0, 4, 5, 3},
+    {2, 0, 1, 5, 3, 4},
+    {3, 5, 4, 0, 2, 1},
+    {4, 3, 5, 1, 0, 2},
+    {5, 4, 3, 2, 1, 0},
+};
+}
+
+CubieCube CubieCube::operator*(const CubieCube& b) const {
+    CubieCube out;
+    for (int i = 0; i < 8; i++) {
+        out.cp[i] = cp[b.cp[i]];
+        out.co[i] = kCornerOriMul[co[b.cp[i]]][b.co[i]];
+    }
+    for (int i = 0; i < 12; i++) {
+        out.ep[i] = ep[b.ep[i]];
+        out.eo[i] = static_cast<uint8_t>((eo[b.ep[i]] + b.eo[i]) & 1);
+    }
+    return out;
+}
+
+CubieCube CubieCube::inverse() const {
+    CubieCube out;
+    for (int i = 0; i < 8; i++) out.cp[cp[i]] = static_cast<uint8_t>(i);
+    for (int i = 0; i < 8; i++) {
+        uint8_t ori = co[out.cp[i]];
+        out.co[i] = ori >= 3 ? ori : static_cast<uint8_t>((3 - ori) % 3);
+    }
+    for (int i = 0; i < 12; i++) out.ep[ep[i]] = static_cast<uint8_t>(i);
+    for (int i = 0; i < 12; i++) out.eo[i] = eo[out.ep[i]];
+    return out;
+}
+
+CubieCube CubieCube::conjugate(const CubieCube& s) const {
+    return s.inverse() * *this * s;
+}
+
+CubieCube CubieCube::fromMoves(const std::vector<Move>& moves) {
+    CubieCube c;
+    for (Move m : moves) c.applyMove(m);
+    return c;
+}
+
+Cube Cube::operator*(const Cube& other) const {
+    Cube out;
+    out.setCubies(cubies() * other.cubies());
+    return out;
+}
+
+Cube Cube::inverse() const {
+    Cube out;
+    out.setCubies(cubies().inverse());
+    return out;
+}
+
+// ============================================================
+// Coordinates
+// ============================================================
+
+namespace {
+int binomial(int n, int k) {
+    if (k < 0 || n < k) return 0;
+    int r = 1;
+    for (int i = 1; i <= k; i++) r = r * (n - k + i) / i;
+    return r;
+}
+
+// Lehmer rank of a permutation of 0..n-1 (identity = 0).
+uint32_t permRank(const uint8_t* p, int n) {
+    uint32_t rank = 0;
+    for (int i = 0; i < n; i++) {
+        int smaller = 0;
+        for (int j = i + 1; j < n; j++) {
+            if (p[j] < p[i]) smaller++;
+        }
+        rank = rank * static_cast<uint32_t>(n - i) + static_cast<uint32_t>(smaller);
+    }
+    return rank;
+}
+
+void permUnrank(uint32_t rank, uint8_t* p, int n) {
+    uint8_t digits[12];
+    for (int i = n - 1; i >= 0; i--) {
+        uint32_t base = static_cast<uint32_t>(n - i);
+        digits[i] = static_cast<uint8_t>(rank % base);
+        rank /= base;
+    }
+    bool used[12] = {};
+    for (int i = 0; i < n; i++) {
+        int skip = digits[i];
+        for (int v = 0; v < n; v++) {
+            if (used[v]) continue;
+            if (skip-- == 0) {
+                p[i] = static_cast<uint8_t>(v);
+                used[v] = true;
+                break;
+            }
+        }
+    }
+}
+
+constexpr int kFirstSliceEdge = 8;  // FR; FR, FL, BL, BR are the UD-slice edges
+}
+
+int CubieCube::twist() const {
+    int t = 0;
+    for (int i = 0; i < 7; i++) t = t * 3 + co[i];
+    return t;
+}
+
+void CubieCube::setTwist(int t) {
+    int sum = 0;
+    for (int i = 6; i >= 0; i--) {
+        co[i] = static_cast<uint8_t>(t % 3);
+        sum += co[i];
+        t /= 3;
+    }
+    co[7] = static_cast<uint8_t>((3 - sum % 3) % 3);
+}
+
+int CubieCube::flip() const {
+    int f = 0;
+    for (int i = 0; i < 11; i++) f = f * 2 + eo[i];
+    return f;
+}
+
+void CubieCube::setFlip(int f) {
+    int sum = 0;
+    for (int i = 10; i >= 0; i--) {
+        eo[i] = static_cast<uint8_t>(f & 1);
+        sum += eo[i];
+        f >>= 1;
+    }
+    eo[11] = static_cast<uint8_t>(sum & 1);
+}
+
+int CubieCube::slice() const {
+    int a = 0;
+    int x = 0;
+    for (int j = 11; j >= 0; j--) {
+        if (ep[j] >= kFirstSliceEdge) {
+            a += binomial(11 - j, x + 1);
+            x++;
+        }
+    }
+    return a;
+}
+
+void CubieCube::setSlice(int s) {
+    setSliceSorted(s * 24);
+}
+
+int CubieCube::sliceSorted() const {
+    uint8_t order[4];
+    int n = 0;
+    for (int j = 0; j < 12; j++) {
+        if (ep[j] >= kFirstSliceEdge) order[n++] = static_cast<uint8_t>(ep[j] - kFirstSliceEdge);
+    }
+    return slice() * 24 + static_cast<int>(permRank(order, 4));
+}
+
+void CubieCube::setSliceSorted(int s) {
+    uint8_t order[4];
+    permUnrank(static_cast<uint32_t>(s % 24), order, 4);
+    int a = s / 24;
+    int x = 4;
+    bool isSlice[12] = {};
+    for (int j = 0; j < 12; j++) {
+        if (a - binomial(11 - j, x) >= 0) {
+            isSlice[j] = true;
+            a -= binomial(11 - j, x);
+            x--;
+        }
+    }
+    int nextSlice = 0;
+    int nextOther = 0;
+    for (int j = 0; j < 12; j++) {
+        ep[j] = isSlice[j] ? static_cast<uint8_t>(kFirstSliceEdge + order[nextSlice++])
+                           : static_cast<uint8_t>(nextOther++);
+    }
+}
+
+int CubieCube::cornerPerm() const {
+    return static_cast<int>(permRank(cp.data(), 8));
+}
+
+void CubieCube::setCornerPerm(int rank) {
+    permUnrank(static_cast<uint32_t>(rank), cp.data(), 8);
+}
+
+uint32_t CubieCube::edgePerm() const {
+    return permRank(ep.data(), 12);
+}
+
+void CubieCube::setEdgePerm(uint32_t rank) {
+    permUnrank(rank, ep.data(), 12);
+}
+
+int CubieCube::udEdges() const {
+    return static_cast<int>(permRank(ep.data(), 8));
+}
+
+void CubieCube::setUdEdges(int rank) {
+    permUnrank(static_cast<uint32_t>(rank), ep.data(), 8);
+    for (int j = kFirstSliceEdge; j < 12; j++) ep[j] = static_cast<uint8_t>(j);
+}
+
+// ============================================================
+// Packed form
+// ============================================================
+
+PackedCube CubieCube::pack() const {
+    PackedCube p;
+    for (int i = 0; i < 8; i++) p.lo |= static_cast<uint64_t>(cp[i] | (co[i] << 3)) << (5 * i);
+    for (int i = 0; i < 12; i++) p.hi |= static_cast<uint64_t>(ep[i] | (eo[i] << 4)) << (5 * i);
+    return p;
+}
+
+CubieCube CubieCube::unpack(const PackedCube& p) {
+    CubieCube c;
+    for (int i = 0; i < 8; i++) {
+        uint64_t bits = p.lo >> (5 * i);
+        c.cp[i] = static_cast<uint8_t>(bits & 7);
+        c.co[i] = static_cast<uint8_t>((bits >> 3) & 3);
+    }
+    for (int i = 0; i < 12; i++) {
+        uint64_t bits = p.hi >> (5 * i);
+        c.ep[i] = static_cast<uint8_t>(bits & 15);
+        c.eo[i] = static_cast<uint8_t>((bits >> 4) & 1);
+    }
+    return c;
+}
+
+bool CubieCube::isValid() const {
+    uint32_t corners = 0;
+    for (int i = 0; i < 8; i++) {
+        if (cp[i] >= 8 || co[i] >= 3) return false;
+        corners |= 1u << cp[i];
+    }
+    uint32_t edges = 0;
+    for (int i = 0; i < 12; i++) {
+        if (ep[i] >= 12 || eo[i] >= 2) return false;
+        edges |= 1u << ep[i];
+    }
+    return corners == 0xFFu && edges == 0xFFFu;
 }
@@ -1,9 +1,11 @@
 #pragma once
 #include <array>
+#include <cstdint>
 #include <vector>
 #include <string>
 #include <random>
 #include <functional>
+#include <type_traits>
 
 enum class Color : uint8_t {
     White,   // U - top
@@ -14,7 +16,7 @@ enum class Color : uint8_t {
     Blue     // R - right
 };
 
-// Standard Rubik's cube moves
+// Standard Rubik's cube moves. Every group of three is CW, CCW, half turn.
 enum class Move : uint8_t {
     U, Up, U2,   // Up face
     D, Dp, D2,   // Down face
@@ -22,29 +24,220 @@ enum class Move : uint8_t {
     R, Rp, R2,   // Right face
     F, Fp, F2,   // Front face
     B, Bp, B2,   // Back face
+    M, Mp, M2,   // middle slice, turns like L
+    E, Ep, E2,   // equatorial slice, turns like D
+    S, Sp, S2,   // standing slice, turns like F
+    Uw, Uwp, Uw2,  // wide moves: the face plus the adjacent slice (u, d, l, r, f, b)
+    Dw, Dwp, Dw2,
+    Lw, Lwp, Lw2,
+    Rw, Rwp, Rw2,
+    Fw, Fwp, Fw2,
+    Bw, Bwp, Bw2,
+    x, xp, x2,   // whole-cube rotations, turning like R, U and F
+    y, yp, y2,
+    z, zp, z2,
     COUNT
 };
 
+// The outer face turns come first; searches and coordinate tables only use these.
+// The remaining moves also move centres, i.e. reorient the cube as a whole.
+constexpr int kFaceMoves = 18;
+inline bool isFaceMove(Move m) { return static_cast<int>(m) < kFaceMoves; }
+
+// Result of Cube::checkSolvable: the first constraint a facelet state violates.
+enum class Solvability : uint8_t {
+    Solvable,
+    BadColor,         // facelet value outside the Color enum
+    BadColorCount,    // some colour does not appear exactly 9 times
+    BadCentres,       // centres are not the standard colour scheme
+    UnknownCorner,    // three stickers that do not form a corner (or form one mirrored)
+    UnknownEdge,      // two stickers that do not form an edge
+    DuplicateCorner,
+    DuplicateEdge,
+    CornerTwist,      // corner orientations do not sum to 0 mod 3
+    EdgeFlip,         // edge orientations do not sum to 0 mod 2
+    Parity,           // corner and edge permutation parities differ
+};
+
 // Face indices
 enum Face : int { FACE_U = 0, FACE_D, FACE_L, FACE_R, FACE_F, FACE_B };
 
-class Cube {
+// Standard colour scheme: centre colour of each face, indexed by Face.
+// This must stay consistent with the cubie colour definitions in cube.cpp.
+inline constexpr Color kFaceColor[6] = {
+    Color::White,   // U
+    Color::Yellow,  // D
+    Color::Green,   // L
+    Color::Blue,    // R
+    Color::Red,     // F
+    Color::Orange,  // B
+};
+
+// CubieCube packed into 128 bits: corners (3-bit permutation, 2-bit orientation) in `lo`,
+// edges (4-bit permutation, 1-bit orientation) in `hi`. Trivially copyable, compares as two
+// 64-bit words; the key type for visited sets and caches.
+struct PackedCube {
+    uint64_t lo = 0;
+    uint64_t hi = 0;
+
+    bool operator==(const PackedCube& other) const { return lo == other.lo && hi == other.hi; }
+    bool operator!=(const PackedCube& other) const { return !(*this == other); }
+
+    uint64_t hash() const {
+        uint64_t h = lo ^ (hi * 0x9E3779B97F4A7C15ull);
+        h ^= h >> 31;
+        h *= 0xBF58476D1CE4E5B9ull;
+        h ^= h >> 29;
+        h *= 0x94D049BB133111EBull;
+        return h ^ (h >> 32);
+    }
+};
+
+struct PackedCubeHash {
+    size_t operator()(const PackedCube& p) const { return static_cast<size_t>(p.hash()); }
+};
+
+// Cubie-level state: which cubie occupies each position and how it is twisted/flipped.
+// Positions and cubies share the indexing documented on Cube (URF.. for corners, UR.. for
+// edges); orientation follows getCornerOrientation/getEdgeOrientation. 40 bytes total.
+struct CubieCube {
+    static constexpr uint8_t kUnknown = 0xFF;  // cubie could not be identified from facelets
+
+    std::array<uint8_t, 8> cp;   // corner permutation: cubie at position i
+    std::array<uint8_t, 8> co;   // corner orientation 0..2 (3..5 only in reflection symmetries)
+    std::array<uint8_t, 12> ep;  // edge permutation: cubie at position i
+    std::array<uint8_t, 12> eo;  // edge orientation 0..1
+
+    CubieCube();  // solved
+
+    // Slice, wide and rotation moves also move the centres; the result is expressed relative
+    // to the new centres, matching Cube::cubies() after the same move.
+    void applyMove(Move m);
+    bool isSolved() const { return *this == CubieCube(); }
+
+    // Group operations. `a * b` is the state reached by doing a's moves and then b's, so
+    // `state * state.inverse()` is solved and a solution path can be verified with one
+    // multiply instead of replaying it. conjugate(s) is s^-1 * this * s.
+    CubieCube operator*(const CubieCube& b) const;
+    CubieCube inverse() const;
+    CubieCube conjugate(const CubieCube& s) const;
+    static CubieCube fromMoves(const std::vector<Move>& moves);
+
+    bool operator==(const CubieCube& other) const;
+    bool operator!=(const CubieCube& other) const { return !(*this == other); }
+
+    // Kociemba coordinates. Each encoder has a matching setter that overwrites only the
+    // pieces/orientations the coordinate describes; CoordTables holds the per-move tables.
+    int twist() const;               // corner orientation 0..2186
+    void setTwist(int twist);
+    int flip() const;                // edge orientation 0..2047
+    void setFlip(int flip);
+    int slice() const;               // UD-slice edge positions, order ignored: 0..494
+    void setSlice(int slice);
+    int sliceSorted() const;         // UD-slice edge positions and order: 0..11879 (< 24 in G1)
+    void setSliceSorted(int sliceSorted);
+    int cornerPerm() const;          // corner permutation rank 0..40319
+    void setCornerPerm(int rank);
+    uint32_t edgePerm() const;       // edge permutation rank 0..479001599
+    void setEdgePerm(uint32_t rank);
+    int udEdges() const;             // permutation of the 8 U/D edges 0..40319; only valid in G1
+    void setUdEdges(int rank);       // also puts the slice edges home
+
+    PackedCube pack() const;  // requires every cubie to be identified (no kUnknown)
+    static CubieCube unpack(const PackedCube& p);
+    // cp and ep are permutations, co < 3 and eo < 2. unpack accepts any 128 bits, so states
+    // from outside (files) must pass this before anything indexes tables with them. Says
+    // nothing about solvability (twist/flip sums, parity).
+    bool isValid() const;
+
+    // Facelet conversion, for the UI boundary. fromFacelets returns false (leaving kUnknown
+    // in the affected slots) when some position does not hold a valid cubie colour set.
+    static bool fromFacelets(const std::array<Color, 54>& facelets, CubieCube& out);
+    std::array<Color, 54> toFacelets() const;
+};
+
+class FaceletGather;
+
+static_assert(sizeof(PackedCube) == 16 && std::is_trivially_copyable<PackedCube>::value,
+              "PackedCube must stay a plain 128-bit value");
+
+template <int N>
+class BasicCube;  // generic NxN engine, see basic_cube.h
+template <>
+class BasicCube<3>;
+using Cube = BasicCube<3>;
+
+// The 3x3 cube: the hand-tuned specialisation of BasicCube (SIMD gathers, incremental
+// misplaced mask and hash, cubie cache). Other sizes use the generic template.
+template <>
+class BasicCube<3> {
 public:
-    Cube();
+    static constexpr int kSize = 3;
+    static constexpr int kFacelets = 54;
+    static constexpr int kMoves = 18 * kSize;
+
+    BasicCube();
 
     void reset();
     void applyMove(Move m);
+    // Layer moves indexed as on NxnGeometry (depth 1 is the middle slice, depth 2 the
+    // opposite face); out-of-range values are ignored.
+    void applyMove(int move);
+    void applyMove(Face face, int depth, int type) { applyMove(moveIndex(face, depth, type)); }
+    void applyMoves(const Move* moves, size_t count);
+    void applyMoves(const std::vector<Move>& moves) { applyMoves(moves.data(), moves.size()); }
+    // Apply a precomposed facelet permutation (see MoveSequence::fused).
+    void applyGather(const FaceletGather& gather);
+    // WCA-style random-move scramble (see Scrambler); the seeded form is reproducible.
     void scramble(int numMoves = 10);
-    bool isSolved() const;
+    void scramble(int numMoves, uint64_t seed);
+    bool isSolved() const { return misplaced_ == 0; }
     bool isSolvable() const;
+    Solvability checkSolvable() const;
+    static const char* solvabilityName(Solvability s);
+
+    bool operator==(const Cube& other) const;
+    bool operator!=(const Cube& other) const { return !(*this == other); }
 
     Color getFacelet(int face, int index) const { return state_[face * 9 + index]; }
+    Color getFacelet(int face, int row, int col) const { return state_[face * 9 + row * 3 + col]; }
     const std::array<Color, 54>& getState() const { return state_; }
 
+    // Facelets whose colour differs from their face's centre, kept up to date by every
+    // move (bit i = facelet i). Makes isSolved O(1) and doubles as a cheap progress /
+    // search-ordering heuristic.
+    uint64_t misplacedMask() const { return misplaced_; }
+    int misplacedCount() const;
+
+    // 64-bit Zobrist hash of the facelets (XOR of a per-facelet, per-colour key).
+    // applyMove updates it with two XORs per relocated facelet, so tables keyed by facelet
+    // state never rehash the 54 bytes. hashFromScratch computes the same value directly.
+    uint64_t hash() const { return hash_; }
+    static uint64_t hashFromScratch(const std::array<Color, 54>& state);
+
     void setState(const std::array<Color, 54>& s);
 
+    // Cubie form of the current facelets. Derived on first use and cached until the
+    // facelets change, so repeated permutation/orientation queries do no colour matching.
+    const CubieCube& cubies() const;
+    void setCubies(const CubieCube& c);
+
+    // Geometric sticker-rotation model that the precomputed move tables are generated from.
+    // Much slower than applyMove; kept so tests can check the tables against it.
+    void applyMoveReference(Move m);
+
+    // Facelet permutation of a move in gather form: after `m`, facelet i holds the
+    // sticker that was previously at index movePermutation(m)[i].
+    static const std::array<uint8_t, 54>& movePermutation(Move m);
+
     static Move inverseMove(Move m);
     static std::string moveToString(Move m);
+    static constexpr int moveIndex(Face face, int depth, int type) { return depth * 18 + face * 3 + type; }
+    static constexpr int inverseMove(int move) {
+        int type = move % 3;
+        return type == 2 ? move : move - type + (1 - type);
+    }
+    static std::string moveToString(int move);
     static const char* colorName(Color c);
 
     // Map a cubie surface coordinate (x,y,z in {-1,0,1}) to a facelet index [0..8] on `face`.
@@ -60,8 +253,35 @@ public:
     int getCornerPermutation(int corner) const;
     int getEdgePermutation(int edge) const;
 
+    // Coordinate view of the cached cubie form (see CubieCube for ranges).
+    int twist() const { return cubies().twist(); }
+    int flip() const { return cubies().flip(); }
+    int slice() const { return cubies().slice(); }
+    int cornerPermutationRank() const { return cubies().cornerPerm(); }
+    uint32_t edgePermutationRank() const { return cubies().edgePerm(); }
+
+    PackedCube packed() const { return cubies().pack(); }
+
+    // Group operations on the cubie form; results are rebuilt in the standard colour scheme.
+    Cube operator*(const Cube& other) const;
+    Cube inverse() const;
+
 private:
-    std::array<Color, 54> state_;  // 6 faces * 9 facelets
+    alignas(16) std::array<Color, 54> state_;  // 6 faces * 9 facelets
+
+    Solvability colorCountProblem() const;
+    void stateChanged();             // full refresh of the derived state below
+    void updateMisplaced(Move m);    // incremental refresh after a face move
 
-    void applyMoveRaw(Move m);
+    alignas(16) std::array<Color, 54> centres_;  // each facelet's centre colour
+    uint64_t misplaced_ = 0;
+    uint64_t hash_ = 0;
+
+    mutable CubieCube cubies_;
+    mutable bool cubiesValid_ = false;
 };
+
+namespace std {
+template <>
+struct hash<PackedCube> : PackedCubeHash {};
+}
@@ -0,0 +1,135 @@
+#include "facelet_gather.h"
+
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define RUBCS_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace {
+// Start offsets of the four 16-byte lanes. The last one overlaps the third so that
+// every load/store stays inside the 54-byte state.
+constexpr int kLaneStart[4] = {0, 16, 32, 38};
+
+int laneOf(int byte) {
+    return byte < 48 ? byte / 16 : 3;
+}
+
+#ifdef RUBCS_X86_SIMD
+bool detectSimd() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("ssse3");
+}
+
+__attribute__((target("ssse3")))
+void gatherSsse3(const uint8_t (*ctrl)[4][16], const uint8_t* in, uint8_t* out) {
+    __m128i src[4];
+    for (int k = 0; k < 4; k++) src[k] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + kLaneStart[k]));
+
+    __m128i dst[4];
+    for (int o = 0; o < 4; o++) {
+        __m128i acc = _mm_shuffle_epi8(src[0], _mm_load_si128(reinterpret_cast<const __m128i*>(ctrl[o][0])));
+        for (int k = 1; k < 4; k++) {
+            acc = _mm_or_si128(acc, _mm_shuffle_epi8(src[k], _mm_load_si128(reinterpret_cast<const __m128i*>(ctrl[o][k]))));
+        }
+        dst[o] = acc;
+    }
+    // All lanes are computed before storing, so in-place gathers are safe.
+    for (int o = 0; o < 4; o++) _mm_storeu_si128(reinterpret_cast<__m128i*>(out + kLaneStart[o]), dst[o]);
+}
+
+__attribute__((target("sse2")))
+bool equalSse2(const uint8_t* a, const uint8_t* b) {
+    __m128i acc = _mm_set1_epi8(-1);
+    for (int k = 0; k < 4; k++) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + kLaneStart[k]));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + kLaneStart[k]));
+        acc = _mm_and_si128(acc, _mm_cmpeq_epi8(va, vb));
+    }
+    return _mm_movemask_epi8(acc) == 0xFFFF;
+}
+
+__attribute__((target("sse2")))
+uint64_t mismatchSse2(const uint8_t* a, const uint8_t* b) {
+    uint64_t equalBits = 0;
+    for (int k = 0; k < 3; k++) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + kLaneStart[k]));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + kLaneStart[k]));
+        equalBits |= static_cast<uint64_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb))) << kLaneStart[k];
+    }
+    // Last lane covers bytes 38..53; only its top 6 bytes are new.
+    __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + kLaneStart[3]));
+    __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + kLaneStart[3]));
+    uint64_t last = static_cast<uint64_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb))) >> 10;
+    equalBits |= last << 48;
+    return ~equalBits & ((uint64_t(1) << 54) - 1);
+}
+
+const bool kSimdSupported = detectSimd();
+#else
+const bool kSimdSupported = false;
+#endif
+
+bool g_simdEnabled = kSimdSupported;
+}
+
+FaceletGather::FaceletGather() {
+    for (int i = 0; i < 54; i++) index_[i] = static_cast<uint8_t>(i);
+    buildControl();
+}
+
+FaceletGather::FaceletGather(const std::array<uint8_t, 54>& index) : index_(index) {
+    buildControl();
+}
+
+void FaceletGather::buildControl() {
+    for (int o = 0; o < 4; o++) {
+        for (int k = 0; k < 4; k++) {
+            for (int j = 0; j < 16; j++) {
+                int src = index_[kLaneStart[o] + j];
+                ctrl_[o][k][j] = laneOf(src) == k ? static_cast<uint8_t>(src - kLaneStart[k]) : 0x80;
+            }
+        }
+    }
+}
+
+void FaceletGather::apply(const uint8_t* in, uint8_t* out) const {
+#ifdef RUBCS_X86_SIMD
+    if (g_simdEnabled) {
+        gatherSsse3(ctrl_, in, out);
+        return;
+    }
+#endif
+    uint8_t tmp[54];
+    for (int i = 0; i < 54; i++) tmp[i] = in[index_[i]];
+    std::memcpy(out, tmp, sizeof(tmp));
+}
+
+bool FaceletGather::equal(const uint8_t* a, const uint8_t* b) {
+#ifdef RUBCS_X86_SIMD
+    if (g_simdEnabled) return equalSse2(a, b);
+#endif
+    return std::memcmp(a, b, 54) == 0;
+}
+
+uint64_t FaceletGather::mismatchMask(const uint8_t* a, const uint8_t* b) {
+#ifdef RUBCS_X86_SIMD
+    if (g_simdEnabled) return mismatchSse2(a, b);
+#endif
+    uint64_t mask = 0;
+    for (int i = 0; i < 54; i++) mask |= static_cast<uint64_t>(a[i] != b[i]) << i;
+    return mask;
+}
+
+bool FaceletGather::simdSupported() {
+    return kSimdSupported;
+}
+
+bool FaceletGather::simdEnabled() {
+    return g_simdEnabled;
+}
+
+void FaceletGather::setSimdEnabled(bool enabled) {
+    g_simdEnabled = enabled && kSimdSupported;
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <array>
+#include <cstdint>
+
+// Byte gather over the 54-byte facelet state: out[i] = in[index[i]].
+//
+// On x86 CPUs with SSSE3 the gather runs as 16 pshufb + OR over four 16-byte
+// lanes (the last lane overlaps bytes 38..53 so no load or store leaves the
+// 54-byte buffer). The path is chosen once at startup from CPU features, with a
+// scalar loop as the fallback.
+class FaceletGather {
+public:
+    FaceletGather();  // identity
+    explicit FaceletGather(const std::array<uint8_t, 54>& index);
+
+    // `in` and `out` may alias.
+    void apply(const uint8_t* in, uint8_t* out) const;
+
+    const std::array<uint8_t, 54>& index() const { return index_; }
+
+    // Byte-wise equality of two 54-byte facelet states.
+    static bool equal(const uint8_t* a, const uint8_t* b);
+    // Bit i set where a[i] != b[i] (bits 54..63 are always clear).
+    static uint64_t mismatchMask(const uint8_t* a, const uint8_t* b);
+
+    static bool simdSupported();
+    static bool simdEnabled();
+    // Force the scalar path (tests/benchmarks). Enabling is ignored without CPU support.
+    static void setSimdEnabled(bool enabled);
+
+private:
+    std::array<uint8_t, 54> index_;
+    // ctrl_[out lane][source lane]: pshufb control, 0x80 where the byte comes from another lane.
+    alignas(16) uint8_t ctrl_[4][4][16];
+
+    void buildControl();
+};
@@ -1,13 +1,75 @@
+#include "batch_file.h"
+#include "notation.h"
 #include "renderer.h"
 #include "solver.h"
+#include <cstring>
 #include <iostream>
 #include <memory>
 
-int main() {
+// Headless batch mode: one URFDLB facelet string per line in, "<facelets> <solution>" out.
+static int solveFile(const char* path) {
+    std::vector<std::array<Color, 54>> states;
+    std::vector<NotationError> errors;
+    if (!Notation::readFaceletFile(path, states, &errors)) {
+        std::cerr << "Cannot read " << path << "\n";
+        return 1;
+    }
+    for (const auto& e : errors) std::cerr << path << ":" << e.line << ": " << e.reason << "\n";
+
+    Solver solver;
+    for (const auto& state : states) {
+        Cube cube;
+        cube.setState(state);
+        auto solution = solver.solve(cube);
+        std::cout << Notation::formatFacelets(state) << " "
+                  << (solution.empty() && !cube.isSolved() ? "-" : Notation::formatMoves(solution)) << "\n";
+    }
+    return errors.empty() ? 0 : 2;
+}
+
+// Binary batch mode: states from a batch file in, the same states with solutions appended to `out`.
+static int solveBatch(const char* in, const char* out) {
+    BatchReader reader;
+    if (!reader.open(in)) {
+        std::cerr << "Cannot read batch file " << in << "\n";
+        return 1;
+    }
+    BatchWriter writer;
+    if (!writer.open(out, true)) {
+        std::cerr << "Cannot write batch file " << out << "\n";
+        return 1;
+    }
+    Solver solver;
+    int failed = 0;
+    for (uint64_t i = 0; i < reader.size(); i++) {
+        CubieCube state;
+        if (!reader.state(i, state)) {
+            std::cerr << in << ": record " << i << " is not a valid state\n";
+            failed++;
+            continue;
+        }
+        Cube cube;
+        cube.setCubies(state);
+        auto solution = solver.solve(cube);
+        if ((solution.empty() && !cube.isSolved()) || !writer.append(reader.state(i), solution)) {
+            std::cerr << in << ": record " << i << " not solved\n";
+            failed++;
+        }
+    }
+    return writer.close() && failed == 0 ? 0 : 2;
+}
+
+int main(int argc, char** argv) {
+    if (argc == 3 && std::strcmp(argv[1], "--solve") == 0) return solveFile(argv[2]);
+    if (argc == 4 && std::strcmp(argv[1], "--solve-batch") == 0) return solveBatch(argv[2], argv[3]);
+
     std::cout << "=== Rubik's Cube 3D ===\n";
     std::cout << "Controls:\n";
     std::cout << "  U/D/L/R/F/B     - rotate face clockwise\n";
-    std::cout << "  Shift + key      - rotate face counter-clockwise\n";
+    std::cout << "  Ctrl + face key  - wide move\n";
+    std::cout << "  M/E/S            - rotate middle slice\n";
+    std::cout << "  X/Y/Z            - rotate whole cube\n";
+    std::cout << "  Shift + key      - rotate counter-clockwise\n";
     std::cout << "  Space            - scramble\n";
     std::cout << "  Enter            - auto-solve (state search)\n";
     std::cout << "  Backspace        - reset\n";
@@ -0,0 +1,166 @@
+#include "notation.h"
+
+#include <cstring>
+#include <fstream>
+
+namespace {
+// URFDLB string order -> internal face index (U, D, L, R, F, B).
+constexpr int kStringFace[6] = {FACE_U, FACE_R, FACE_F, FACE_D, FACE_L, FACE_B};
+constexpr char kFaceLetter[6] = {'U', 'D', 'L', 'R', 'F', 'B'};
+
+constexpr uint8_t kInvalid = 0xFF;
+
+struct LetterTable {
+    uint8_t color[256] = {};
+};
+
+constexpr LetterTable buildLetterTable() {
+    LetterTable t{};
+    for (int i = 0; i < 256; i++) t.color[i] = kInvalid;
+    for (int f = 0; f < 6; f++) t.color[static_cast<uint8_t>(kFaceLetter[f])] = static_cast<uint8_t>(kFaceColor[f]);
+    return t;
+}
+
+constexpr LetterTable kLetterColor = buildLetterTable();
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// Move group (see Move) of a token's letter part, or -1.
+int moveGroup(std::string_view letters) {
+    static constexpr const char* kGroups[18][2] = {
+        {"U", nullptr}, {"D", nullptr}, {"L", nullptr}, {"R", nullptr}, {"F", nullptr}, {"B", nullptr},
+        {"M", nullptr}, {"E", nullptr}, {"S", nullptr},
+        {"u", "Uw"}, {"d", "Dw"}, {"l", "Lw"}, {"r", "Rw"}, {"f", "Fw"}, {"b", "Bw"},
+        {"x", nullptr}, {"y", nullptr}, {"z", nullptr},
+    };
+    for (int g = 0; g < 18; g++) {
+        for (const char* name : kGroups[g]) {
+            if (name && letters == name) return g;
+        }
+    }
+    return -1;
+}
+}
+
+bool Notation::parseFacelets(std::string_view text, std::array<Color, 54>& out) {
+    if (text.size() != 54) return false;
+    std::array<Color, 54> f;
+    uint8_t bad = 0;
+    for (int k = 0; k < 54; k++) {
+        uint8_t c = kLetterColor.color[static_cast<uint8_t>(text[k])];
+        bad |= c;
+        f[kStringFace[k / 9] * 9 + k % 9] = static_cast<Color>(c);
+    }
+    if (bad & 0x80) return false;
+    out = f;
+    return true;
+}
+
+std::string Notation::formatFacelets(const std::array<Color, 54>& facelets) {
+    char letterOf[256];
+    std::memset(letterOf, '?', sizeof(letterOf));
+    for (int f = 0; f < 6; f++) letterOf[static_cast<uint8_t>(facelets[f * 9 + 4])] = kFaceLetter[f];
+
+    std::string out(54, '?');
+    for (int k = 0; k < 54; k++) {
+        out[k] = letterOf[static_cast<uint8_t>(facelets[kStringFace[k / 9] * 9 + k % 9])];
+    }
+    return out;
+}
+
+bool Notation::parseMove(std::string_view token, Move& out) {
+    int type = 0;
+    if (token.size() >= 2 && token.substr(token.size() - 2) == "2'") {
+        type = 2;
+        token.remove_suffix(2);
+    } else if (!token.empty() && token.back() == '2') {
+        type = 2;
+        token.remove_suffix(1);
+    } else if (!token.empty() && token.back() == '\'') {
+        type = 1;
+        token.remove_suffix(1);
+    }
+    int group = moveGroup(token);
+    if (group < 0) return false;
+    out = static_cast<Move>(group * 3 + type);
+    return true;
+}
+
+bool Notation::parseMoves(std::string_view text, std::vector<Move>& out) {
+    size_t restore = out.size();
+    size_t i = 0;
+    while (i < text.size()) {
+        while (i < text.size() && isSpace(text[i])) i++;
+        size_t start = i;
+        while (i < text.size() && !isSpace(text[i])) i++;
+        if (start == i) break;
+        Move m;
+        if (!parseMove(text.substr(start, i - start), m)) {
+            out.resize(restore);
+            return false;
+        }
+        out.push_back(m);
+    }
+    return true;
+}
+
+std::string Notation::formatMoves(const std::vector<Move>& moves) {
+    std::string out;
+    for (Move m : moves) {
+        if (m == Move::COUNT) continue;
+        if (!out.empty()) out += ' ';
+        out += Cube::moveToString(m);
+    }
+    return out;
+}
+
+size_t Notation::parseFaceletLines(std::string_view text, std::vector<std::array<Color, 54>>& states,
+                                   std::vector<NotationError>* errors) {
+    size_t added = 0;
+    size_t lineNo = 0;
+    Cube check;
+    const char* p = text.data();
+    const char* end = p + text.size();
+    while (p < end) {
+        const char* eol = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(end - p)));
+        if (!eol) eol = end;
+        std::string_view line(p, static_cast<size_t>(eol - p));
+        p = eol + 1;
+        lineNo++;
+
+        while (!line.empty() && isSpace(line.back())) line.remove_suffix(1);
+        while (!line.empty() && isSpace(line.front())) line.remove_prefix(1);
+        if (line.empty() || line.front() == '#') continue;
+
+        std::array<Color, 54> facelets;
+        if (!parseFacelets(line, facelets)) {
+            if (errors) errors->push_back({lineNo, "expected 54 characters from URFDLB"});
+            continue;
+        }
+        check.setState(facelets);
+        Solvability s = check.checkSolvable();
+        if (s != Solvability::Solvable) {
+            if (errors) errors->push_back({lineNo, Cube::solvabilityName(s)});
+            continue;
+        }
+        states.push_back(facelets);
+        added++;
+    }
+    return added;
+}
+
+bool Notation::readFaceletFile(const std::string& path, std::vector<std::array<Color, 54>>& states,
+                               std::vector<NotationError>* errors) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    in.seekg(0, std::ios::end);
+    std::streamoff size = in.tellg();
+    if (size < 0) return false;
+    in.seekg(0, std::ios::beg);
+    std::string data(static_cast<size_t>(size), '\0');
+    if (!in.read(&data[0], size)) return false;
+    parseFaceletLines(data, states, errors);
+    return true;
+}
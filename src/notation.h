@@ -0,0 +1,43 @@
+#pragma once
+#include "cube.h"
+#include <array>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Text formats for getting states and move sequences in and out of the program.
+//
+// Facelet strings use the common 54-character URFDLB notation: faces in the order
+// U, R, F, D, L, B, nine facelets each in reading order, each character naming the face
+// whose centre colour the sticker has. A solved cube reads
+// UUUUUUUUURRRRRRRRRFFFFFFFFFDDDDDDDDDLLLLLLLLLBBBBBBBBB.
+//
+// Move strings are whitespace-separated tokens in the usual notation: U R' F2, slice moves
+// M E S, wide moves as r or Rw, rotations x y z. "R2'" is accepted as R2.
+struct NotationError {
+    size_t line;         // 1-based
+    std::string reason;
+};
+
+class Notation {
+public:
+    // Fails on wrong length or characters other than URFDLB. Does not check solvability.
+    static bool parseFacelets(std::string_view text, std::array<Color, 54>& out);
+    // Letters are taken relative to the centres, so a rotated cube still formats correctly.
+    static std::string formatFacelets(const std::array<Color, 54>& facelets);
+
+    static bool parseMove(std::string_view token, Move& out);
+    // Appends to `out`; on failure `out` is left as it was.
+    static bool parseMoves(std::string_view text, std::vector<Move>& out);
+    static std::string formatMoves(const std::vector<Move>& moves);
+
+    // Bulk reader for one facelet string per line. Blank lines and lines starting with '#'
+    // are skipped; every other line must parse and be solvable, otherwise it is reported in
+    // `errors` (when given) and left out of `states`. Returns the number of states appended.
+    static size_t parseFaceletLines(std::string_view text, std::vector<std::array<Color, 54>>& states,
+                                    std::vector<NotationError>* errors = nullptr);
+    // Whole-file version; returns false only when the file cannot be read.
+    static bool readFaceletFile(const std::string& path, std::vector<std::array<Color, 54>>& states,
+                                std::vector<NotationError>* errors = nullptr);
+};
@@ -0,0 +1,381 @@
+#include "optimal.h"
+#include "coord.h"
+#include "move_automaton.h"
+#include "symmetry.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <mutex>
+
+namespace {
+
+constexpr int kUnvisited = 15;
+constexpr int kGroup = OptimalTables::kEdgeGroup;
+
+// Position * 2 + orientation of each edge cubie the table covers, in kEdgeCubies order.
+using EdgeState = std::array<uint8_t, kGroup>;
+
+void setNibble(std::vector<uint8_t>& table, size_t i, int value) {
+    int shift = static_cast<int>(i & 1) * 4;
+    table[i >> 1] = static_cast<uint8_t>((table[i >> 1] & ~(15 << shift)) | (value << shift));
+}
+
+// Positions ranked as a partial permutation (radices 12, 11, ..., 7), then orientations.
+uint32_t edgeIndex(const EdgeState& e) {
+    uint32_t used = 0;
+    uint32_t rank = 0;
+    uint32_t flips = 0;
+    for (int j = 0; j < kGroup; j++) {
+        unsigned pos = e[j] >> 1;
+        rank = rank * static_cast<uint32_t>(12 - j) +
+               (pos - static_cast<unsigned>(__builtin_popcount(used & ((1u << pos) - 1))));
+        used |= 1u << pos;
+        flips = flips * 2 + (e[j] & 1u);
+    }
+    return rank << kGroup | flips;
+}
+
+EdgeState edgeStateAt(uint32_t index) {
+    uint32_t flips = index & ((1u << kGroup) - 1);
+    uint32_t rank = index >> kGroup;
+    int digits[kGroup];
+    for (int j = kGroup - 1; j >= 0; j--) {
+        digits[j] = static_cast<int>(rank % static_cast<uint32_t>(12 - j));
+        rank /= static_cast<uint32_t>(12 - j);
+    }
+    EdgeState e{};
+    uint32_t used = 0;
+    for (int j = 0; j < kGroup; j++) {
+        int pos = 0;
+        for (int skip = digits[j];; pos++) {
+            if ((used >> pos) & 1u) continue;
+            if (skip-- == 0) break;
+        }
+        used |= 1u << pos;
+        e[j] = static_cast<uint8_t>(pos * 2 + ((flips >> (kGroup - 1 - j)) & 1u));
+    }
+    return e;
+}
+
+EdgeState edgeStateOf(const CubieCube& c) {
+    EdgeState e{};
+    for (int i = 0; i < 12; i++) {
+        for (int j = 0; j < kGroup; j++) {
+            if (c.ep[i] == OptimalTables::kEdgeCubies[j]) e[j] = static_cast<uint8_t>(i * 2 + c.eo[i]);
+        }
+    }
+    return e;
+}
+
+// Breadth-first fill of a nibble table, one scan per depth. expand(i, visit) calls visit(j)
+// for each neighbour j of entry i.
+template <typename Expand>
+void buildNibbles(std::vector<uint8_t>& table, size_t size, size_t goal, Expand expand) {
+    table.assign((size + 1) / 2, 0xFF);
+    setNibble(table, goal, 0);
+    size_t filled = 1;
+    for (int depth = 0; filled < size && depth + 1 < kUnvisited; depth++) {
+        size_t before = filled;
+        for (size_t i = 0; i < size; i++) {
+            if (OptimalTables::nibble(table, i) != depth) continue;
+            expand(i, [&](size_t j) {
+                if (OptimalTables::nibble(table, j) != kUnvisited) return;
+                setNibble(table, j, depth + 1);
+                filled++;
+            });
+        }
+        if (filled == before) break;
+    }
+}
+
+size_t at(int coord, int move) {
+    return static_cast<size_t>(coord) * CoordTables::kMoves + static_cast<size_t>(move);
+}
+
+// The tree is split kSplitDepth moves below the root (a few thousand subtrees before
+// pruning) and the subtrees are searched in parallel, each worker with its own path.
+constexpr int kSplitDepth = 3;
+
+class Search {
+public:
+    Search(const CubieCube& start, std::atomic_bool* cancel, SolverProgress* progress, WorkStealingPool& pool)
+        : coords_(CoordTables::get()),
+          tables_(OptimalTables::get()),
+          cancel_(cancel),
+          progress_(progress),
+          pool_(pool),
+          workers_(pool.size()) {
+        start_.corners = static_cast<uint16_t>(start.cornerPerm());
+        start_.twist = static_cast<uint16_t>(start.twist());
+        start_.edges = edgeStateOf(start);
+        start_.mirrored = edgeStateOf(Symmetry::conjugate(start, tables_.edgeSym));
+        for (int m = 0; m < kFaceMoves; m++) {
+            mirroredMove_[m] = static_cast<uint8_t>(Symmetry::conjugateMove(static_cast<Move>(m), tables_.edgeSym));
+        }
+    }
+
+    std::vector<Move> run(int maxLength) {
+        if (cancel_ && cancel_->load(std::memory_order_relaxed)) return {};
+        for (int depth = bound(start_); depth <= maxLength && !stopped(); depth++) {
+            if (progress_) progress_->depth.store(depth, std::memory_order_relaxed);
+            roots_.clear();
+            Root root{};
+            split(start_, root, depth, MoveAutomaton::kStart);
+            pool_.run(roots_.size(), [this](size_t i, unsigned worker) { searchRoot(roots_[i], workers_[worker]); });
+            if (!solution_.empty()) break;
+        }
+        for (auto& w : workers_) flushNodes(w);
+        return solution_;
+    }
+
+private:
+    struct Node {
+        uint16_t corners;
+        uint16_t twist;
+        EdgeState edges;     // kEdgeCubies in the state itself
+        EdgeState mirrored;  // kEdgeCubies in the edgeSym conjugate: the other six edges
+    };
+
+    struct Root {
+        Node node;
+        Move prefix[kSplitDepth];
+        int length;
+        int togo;
+        int automaton;
+    };
+
+    // Per-thread search state. Workers sit side by side in workers_ and bump their node
+    // counters constantly, so each gets its own cache line.
+    struct alignas(64) Worker {
+        Move path[OptimalSolver::kMaxLength + 1] = {};
+        uint64_t nodes = 0;
+        uint64_t reported = 0;
+    };
+
+    bool stopped() const { return stop_.load(std::memory_order_relaxed); }
+
+    int bound(const Node& n) const {
+        int h = tables_.cornerDistance(n.corners, n.twist);
+        h = std::max(h, OptimalTables::nibble(tables_.edges, edgeIndex(n.edges)));
+        return std::max(h, OptimalTables::nibble(tables_.edges, edgeIndex(n.mirrored)));
+    }
+
+    // False when the child cannot be solved in togo - 1 further moves.
+    bool advance(const Node& n, int m, int togo, Node& child) const {
+        child.corners = coords_.cornerPermMove[at(n.corners, m)];
+        child.twist = coords_.twistMove[at(n.twist, m)];
+        // The corner bound is the cheapest and prunes most often, so it goes first.
+        if (tables_.cornerDistance(child.corners, child.twist) >= togo) return false;
+        for (int j = 0; j < kGroup; j++) {
+            child.edges[j] = tables_.edgeMove[m][n.edges[j]];
+            child.mirrored[j] = tables_.edgeMove[mirroredMove_[m]][n.mirrored[j]];
+        }
+        return bound(child) < togo;
+    }
+
+    void countNode(Worker& w) {
+        if (++w.nodes % 4096 != 0) return;
+        flushNodes(w);
+        if (cancel_ && cancel_->load(std::memory_order_relaxed)) stop_.store(true, std::memory_order_relaxed);
+    }
+
+    void flushNodes(Worker& w) {
+        if (progress_) progress_->nodes.fetch_add(w.nodes - w.reported, std::memory_order_relaxed);
+        w.reported = w.nodes;
+    }
+
+    // Collects the nodes kSplitDepth moves down (or fewer, where togo runs out) in order.
+    void split(const Node& n, Root& root, int togo, int automaton) {
+        if (root.length == kSplitDepth || togo == 0) {
+            root.node = n;
+            root.togo = togo;
+            root.automaton = automaton;
+            roots_.push_back(root);
+            return;
+        }
+        for (uint32_t moves = MoveAutomaton::allowed(automaton); moves; moves &= moves - 1) {
+            int m = __builtin_ctz(moves);
+            Node child;
+            if (!advance(n, m, togo, child)) continue;
+            countNode(workers_[0]);
+            root.prefix[root.length++] = static_cast<Move>(m);
+            split(child, root, togo - 1, MoveAutomaton::next(static_cast<Move>(m)));
+            root.length--;
+        }
+    }
+
+    void searchRoot(const Root& root, Worker& w) {
+        if (stopped()) return;
+        std::copy(root.prefix, root.prefix + root.length, w.path);
+        if (!search(w, root.node, root.length, root.togo, root.automaton)) return;
+        std::lock_guard<std::mutex> lock(solutionMutex_);
+        if (!solution_.empty()) return;  // another worker got there first, same length
+        solution_.assign(w.path, w.path + root.length + root.togo);
+        stop_.store(true, std::memory_order_relaxed);
+    }
+
+    // Bounds are checked before descending, so reaching togo == 0 means every table is at 0.
+    bool search(Worker& w, const Node& n, int depth, int togo, int automaton) {
+        if (togo == 0) return true;
+        for (uint32_t moves = MoveAutomaton::allowed(automaton); moves && !stopped(); moves &= moves - 1) {
+            int m = __builtin_ctz(moves);
+            Node child;
+            if (!advance(n, m, togo, child)) continue;
+            countNode(w);
+            w.path[depth] = static_cast<Move>(m);
+            if (search(w, child, depth + 1, togo - 1, MoveAutomaton::next(static_cast<Move>(m)))) return true;
+        }
+        return false;
+    }
+
+    const CoordTables& coords_;
+    const OptimalTables& tables_;
+    std::atomic_bool* cancel_;
+    SolverProgress* progress_;
+    WorkStealingPool& pool_;
+
+    Node start_{};
+    uint8_t mirroredMove_[kFaceMoves] = {};
+    std::vector<Root> roots_;
+    std::vector<Worker> workers_;
+    std::atomic_bool stop_{false};  // solution found or cancelled
+    std::mutex solutionMutex_;
+    std::vector<Move> solution_;
+};
+
+} // namespace
+
+constexpr uint8_t OptimalTables::kEdgeCubies[];
+
+int OptimalTables::cornerDistance(int cornerPerm, int twist) const {
+    size_t cls = cornerClass[static_cast<size_t>(cornerPerm)];
+    int conj = Symmetry::twistConj(twist, cornerSym[static_cast<size_t>(cornerPerm)]);
+    return nibble(corners, cls * CoordTables::kTwist + static_cast<size_t>(conj));
+}
+
+OptimalTables::OptimalTables() {
+    const CoordTables& t = CoordTables::get();
+
+    // Corner permutation classes under the 16 U-D symmetries.
+    cornerClass.assign(CoordTables::kCornerPerm, 0xFFFF);
+    cornerSym.assign(CoordTables::kCornerPerm, 0);
+    for (int cp = 0; cp < CoordTables::kCornerPerm; cp++) {
+        if (cornerClass[cp] != 0xFFFF) continue;
+        auto cls = static_cast<uint16_t>(cornerClasses++);
+        cornerRep.push_back(static_cast<uint16_t>(cp));
+        cornerStabilizer.push_back(0);
+        for (int s = 0; s < Symmetry::kUDCount; s++) {
+            int q = Symmetry::cornerPermConj(cp, s);
+            if (q == cp) cornerStabilizer.back() |= static_cast<uint16_t>(1u << s);
+            if (cornerClass[q] != 0xFFFF) continue;
+            // q = S^-1 cp S, so conjugating q by S^-1 gives cp back.
+            cornerClass[q] = cls;
+            cornerSym[q] = static_cast<uint8_t>(Symmetry::inverse(s));
+        }
+    }
+    assert(cornerClasses == kMaxCornerClasses);
+
+    buildNibbles(corners, static_cast<size_t>(cornerClasses) * CoordTables::kTwist, 0,
+                 [&](size_t i, auto&& visit) {
+                     int cp = cornerRep[i / CoordTables::kTwist];
+                     int twist = static_cast<int>(i % CoordTables::kTwist);
+                     for (int m = 0; m < kFaceMoves; m++) {
+                         int nextCp = t.cornerPermMove[at(cp, m)];
+                         int nextTwist = Symmetry::twistConj(t.twistMove[at(twist, m)], cornerSym[nextCp]);
+                         size_t cls = cornerClass[nextCp];
+                         // A representative fixed by other symmetries has several entries for
+                         // one state up to symmetry; they must all get the same distance.
+                         for (unsigned stab = cornerStabilizer[cls]; stab; stab &= stab - 1) {
+                             int conj = Symmetry::twistConj(nextTwist, __builtin_ctz(stab));
+                             visit(cls * CoordTables::kTwist + static_cast<size_t>(conj));
+                         }
+                     }
+                 });
+
+    // (a * M).ep[i] = a.ep[M.ep[i]]: the edge at M.ep[i] moves to i, flipped by M.eo[i].
+    for (int m = 0; m < kFaceMoves; m++) {
+        CubieCube move = CubieCube::fromMoves({static_cast<Move>(m)});
+        for (int i = 0; i < 12; i++) {
+            for (int flip = 0; flip < 2; flip++) {
+                edgeMove[m][move.ep[i] * 2 + flip] = static_cast<uint8_t>(i * 2 + (flip ^ move.eo[i]));
+            }
+        }
+    }
+
+    // The symmetry whose conjugation carries the uncovered edges onto kEdgeCubies.
+    for (int s = 0; s < Symmetry::kCount; s++) {
+        const CubieCube& inv = Symmetry::cube(Symmetry::inverse(s));
+        bool maps = true;
+        for (int e = 0; e < 12; e++) {
+            bool covered = std::find(std::begin(kEdgeCubies), std::end(kEdgeCubies), e) != std::end(kEdgeCubies);
+            bool image = std::find(std::begin(kEdgeCubies), std::end(kEdgeCubies), inv.ep[e]) != std::end(kEdgeCubies);
+            maps = maps && covered != image;
+        }
+        if (maps) {
+            edgeSym = s;
+            break;
+        }
+    }
+
+    // A move sends the covered edges to new positions and flips some of them, and both
+    // depend only on the positions: one transition per position rank serves all 64 flip
+    // patterns, so the table is filled a position rank at a time.
+    // Once most entries are filled, it is cheaper to go backwards: each unvisited entry
+    // looks for a neighbour at the current depth (moves come in inverse pairs).
+    edges.assign(kEdgeEntries / 2, 0xFF);
+    uint32_t goal = edgeIndex(edgeStateOf(CubieCube()));
+    setNibble(edges, goal, 0);
+    uint32_t filled = 1;
+    uint32_t level = 1;  // entries at the current depth
+    std::vector<uint32_t> step(kFaceMoves);  // next rank << kGroup | flip mask
+    for (int depth = 0; level > 0 && depth + 1 < kUnvisited; depth++) {
+        bool backward = kEdgeEntries - filled < level;
+        int from = backward ? kUnvisited : depth;
+        uint32_t before = filled;
+        for (uint32_t rank = 0; rank < kEdgePositions; rank++) {
+            size_t base = static_cast<size_t>(rank) << kGroup;
+            bool any = false;
+            for (uint32_t flips = 0; flips < (1u << kGroup) && !any; flips++) any = nibble(edges, base + flips) == from;
+            if (!any) continue;
+            EdgeState e = edgeStateAt(rank << kGroup);
+            for (int m = 0; m < kFaceMoves; m++) {
+                EdgeState next;
+                for (int j = 0; j < kGroup; j++) next[j] = edgeMove[m][e[j]];
+                step[m] = edgeIndex(next);
+            }
+            for (uint32_t flips = 0; flips < (1u << kGroup); flips++) {
+                if (nibble(edges, base + flips) != from) continue;
+                for (int m = 0; m < kFaceMoves; m++) {
+                    size_t j = step[m] ^ flips;
+                    if (backward) {
+                        if (nibble(edges, j) != depth) continue;
+                        setNibble(edges, base + flips, depth + 1);
+                        filled++;
+                        break;
+                    }
+                    if (nibble(edges, j) != kUnvisited) continue;
+                    setNibble(edges, j, depth + 1);
+                    filled++;
+                }
+            }
+        }
+        level = filled - before;
+    }
+}
+
+const OptimalTables& OptimalTables::get() {
+    static const OptimalTables tables;
+    return tables;
+}
+
+std::vector<Move> OptimalSolver::solve(const CubieCube& start,
+                                       std::atomic_bool* cancel,
+                                       SolverProgress* progress,
+                                       int maxLength,
+                                       unsigned threads) {
+    if (start.isSolved()) return {};
+    WorkStealingPool pool(threads);
+    return Search(start, cancel, progress, pool).run(std::min(maxLength, kMaxLength));
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include "cube.h"
+#include "solver.h"
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// Pattern databases for the optimal search, 4 bits per entry (exact distances never pass 15).
+//
+// Corners: corner permutation reduced by the 16 symmetries that keep the U-D axis, times
+// the twist conjugated by the same symmetry (2768 classes x 2187, about 3 MB).
+//
+// Edges: the six edges UR, UF, UL, UB, FR, FL with their orientations (12!/6! x 2^6 entries,
+// about 21 MB, not symmetry-reduced: that set is not closed under the U-D symmetries). The
+// other six edges are the image of these under a symmetry, so the same table also bounds
+// them through the conjugated state. The corner bound dominates (mean 8.8 of 8.9 over
+// random states); more conjugated lookups of this table add under 0.1.
+struct OptimalTables {
+    static constexpr int kEdgeGroup = 6;
+    static constexpr uint32_t kEdgePositions = 12 * 11 * 10 * 9 * 8 * 7;
+    static constexpr uint32_t kEdgeEntries = kEdgePositions << kEdgeGroup;
+    static constexpr int kMaxCornerClasses = 2768;
+
+    // Edge cubies covered by the table, and the symmetry mapping the others onto them.
+    static constexpr uint8_t kEdgeCubies[kEdgeGroup] = {0, 1, 2, 3, 8, 9};
+    int edgeSym = 0;
+
+    int cornerClasses = 0;
+    std::vector<uint16_t> cornerClass;       // [cornerPerm]
+    std::vector<uint8_t> cornerSym;          // [cornerPerm]: conjugating by it gives the representative
+    std::vector<uint16_t> cornerRep;         // [class]
+    std::vector<uint16_t> cornerStabilizer;  // [class]: bit s set when s fixes the representative
+    std::vector<uint8_t> corners;            // nibbles, [class * kTwist + conjugated twist]
+    std::vector<uint8_t> edges;              // nibbles, [edgeIndex]
+
+    // Position * 2 + orientation of an edge after each face move.
+    uint8_t edgeMove[kFaceMoves][24] = {};
+
+    static int nibble(const std::vector<uint8_t>& table, size_t i) { return (table[i >> 1] >> ((i & 1) * 4)) & 15; }
+
+    int cornerDistance(int cornerPerm, int twist) const;
+
+    // Built on first use (thread-safe, several seconds) and shared read-only afterwards.
+    static const OptimalTables& get();
+
+private:
+    OptimalTables();
+};
+
+// Korf-style optimal solver for short scrambles: IDA* over face moves with the
+// OptimalTables bounds. Every solution it returns is as short as possible; the price is
+// time, which grows about 12x per extra move of depth. On one core (rubcs_bench): 13-move
+// solutions take about 0.2 s, and exhausting depth 15 takes about 45 s, so typical random
+// states (17-18 moves) take hours. Each depth iteration is split into subtrees a few moves
+// down and spread over a WorkStealingPool; the first worker to find a solution stops the rest.
+class OptimalSolver {
+public:
+    static constexpr int kMaxLength = 20;  // God's number in the face-turn metric
+
+    // Empty when `start` is solved, the search was cancelled, or no solution of at most
+    // `maxLength` moves exists. `start` must be solvable. `threads` 0: one per core.
+    static std::vector<Move> solve(const CubieCube& start,
+                                   std::atomic_bool* cancel = nullptr,
+                                   SolverProgress* progress = nullptr,
+                                   int maxLength = kMaxLength,
+                                   unsigned threads = 0);
+};
@@ -0,0 +1,91 @@
+#include "random_state.h"
+
+#include "move_automaton.h"
+
+#include <algorithm>
+#include <thread>
+#include <utility>
+
+namespace {
+// Fisher-Yates shuffle of an identity permutation; returns its parity.
+template <size_t N>
+int shuffle(std::array<uint8_t, N>& p, Rng& rng) {
+    for (size_t i = 0; i < N; i++) p[i] = static_cast<uint8_t>(i);
+    int parity = 0;
+    for (size_t i = N - 1; i > 0; i--) {
+        size_t j = rng.below(static_cast<uint32_t>(i + 1));
+        // Branch-free: j == i is a coin flip the predictor cannot learn.
+        std::swap(p[i], p[j]);
+        parity ^= j != i;
+    }
+    return parity;
+}
+
+void writeScramble(Rng& rng, Move* out, int length) {
+    int state = MoveAutomaton::kStart;
+    for (int i = 0; i < length; i++) {
+        uint32_t allowed = MoveAutomaton::allowed(state);
+        for (uint32_t k = rng.below(static_cast<uint32_t>(__builtin_popcount(allowed))); k > 0; k--) {
+            allowed &= allowed - 1;
+        }
+        Move m = static_cast<Move>(__builtin_ctz(allowed));
+        out[i] = m;
+        state = MoveAutomaton::next(m);
+    }
+}
+}
+
+CubieCube RandomStateGenerator::next() {
+    CubieCube c;
+    int cornerParity = shuffle(c.cp, rng_);
+    int edgeParity = shuffle(c.ep, rng_);
+    // Swapping two edges pairs every odd edge permutation with an even one, so the fixup
+    // keeps the distribution uniform over the legal half.
+    if (cornerParity != edgeParity) std::swap(c.ep[10], c.ep[11]);
+    c.setTwist(static_cast<int>(rng_.below(2187)));
+    c.setFlip(static_cast<int>(rng_.next() & 2047));
+    return c;
+}
+
+std::vector<Move> ScrambleBatch::scramble(size_t i) const {
+    auto first = moves.begin() + static_cast<std::ptrdiff_t>(i * static_cast<size_t>(length));
+    return std::vector<Move>(first, first + length);
+}
+
+std::vector<Move> Scrambler::generate(Rng& rng, int length) {
+    std::vector<Move> out(static_cast<size_t>(std::max(length, 0)));
+    writeScramble(rng, out.data(), static_cast<int>(out.size()));
+    return out;
+}
+
+std::vector<Move> Scrambler::generate(uint64_t seed, size_t index, int length) {
+    Rng rng(Rng::streamSeed(seed, index));
+    return generate(rng, length);
+}
+
+ScrambleBatch Scrambler::batch(uint64_t seed, size_t count, int length, unsigned threads) {
+    ScrambleBatch out;
+    out.length = std::max(length, 0);
+    out.moves.resize(count * static_cast<size_t>(out.length));
+    out.states.resize(count);
+
+    auto work = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            Rng rng(Rng::streamSeed(seed, i));
+            Move* moves = out.moves.data() + i * static_cast<size_t>(out.length);
+            writeScramble(rng, moves, out.length);
+            CubieCube c;
+            for (int k = 0; k < out.length; k++) c.applyMove(moves[k]);
+            out.states[i] = c.pack();
+        }
+    };
+
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    // Below a few thousand scrambles thread start-up costs more than it saves.
+    size_t workers = std::min<size_t>(threads, std::max<size_t>(1, count / 4096));
+    std::vector<std::thread> pool;
+    for (size_t w = 1; w < workers; w++) pool.emplace_back(work, count * w / workers, count * (w + 1) / workers);
+    work(0, count / workers);
+    for (auto& t : pool) t.join();
+    return out;
+}
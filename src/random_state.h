@@ -0,0 +1,96 @@
+#pragma once
+#include "cube.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Small seeded PRNG (xoshiro256**, seeded through splitmix64). Much cheaper than
+// std::mt19937 and fully determined by its seed, so corpora and scrambles can be
+// regenerated from a single number.
+class Rng {
+public:
+    explicit Rng(uint64_t seed = 0) { reseed(seed); }
+
+    void reseed(uint64_t seed) {
+        for (auto& word : s_) {
+            uint64_t z = (seed += 0x9E3779B97F4A7C15ull);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            word = z ^ (z >> 31);
+        }
+    }
+
+    // Seed for item `index` of a bulk job, so each item's stream depends only on the job
+    // seed and its index, never on how the job was split across threads.
+    static uint64_t streamSeed(uint64_t seed, uint64_t index) {
+        uint64_t z = seed ^ (index * 0xD1B54A32D192ED03ull);
+        z = (z ^ (z >> 32)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 29)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 32);
+    }
+
+    uint64_t next() {
+        uint64_t result = rotl(s_[1] * 5, 7) * 9;
+        uint64_t t = s_[1] << 17;
+        s_[2] ^= s_[0];
+        s_[3] ^= s_[1];
+        s_[1] ^= s_[2];
+        s_[0] ^= s_[3];
+        s_[2] ^= t;
+        s_[3] = rotl(s_[3], 45);
+        return result;
+    }
+
+    // Unbiased value in [0, bound) for 0 < bound < 2^32 (Lemire's multiply-and-reject).
+    uint32_t below(uint32_t bound) {
+        uint64_t m = (next() >> 32) * bound;
+        if (static_cast<uint32_t>(m) < bound) {
+            uint32_t threshold = static_cast<uint32_t>(-bound) % bound;
+            while (static_cast<uint32_t>(m) < threshold) m = (next() >> 32) * bound;
+        }
+        return static_cast<uint32_t>(m >> 32);
+    }
+
+private:
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+    uint64_t s_[4];
+};
+
+// Uniformly distributed legal states, built directly on the cubies: random corner and edge
+// permutations (Fisher-Yates), random twist and flip, and the last two edges swapped when
+// the permutation parities differ. Every one of the 43252003274489856000 states is equally
+// likely, unlike a random-move scramble, which favours states close to solved.
+class RandomStateGenerator {
+public:
+    explicit RandomStateGenerator(uint64_t seed) : rng_(seed) {}
+
+    CubieCube next();
+    PackedCube nextPacked() { return next().pack(); }
+
+private:
+    Rng rng_;
+};
+
+// Random-move scrambles with WCA-style constraints: no face is turned twice in a row and
+// opposite faces never form a redundant triple such as U D U. Moves are drawn uniformly
+// from those MoveAutomaton allows, so scrambles are also canonical (U D, never D U).
+struct ScrambleBatch {
+    int length = 0;
+    std::vector<Move> moves;         // scramble i is moves[i * length, (i + 1) * length)
+    std::vector<PackedCube> states;  // state reached from solved by scramble i
+
+    size_t size() const { return states.size(); }
+    std::vector<Move> scramble(size_t i) const;
+};
+
+class Scrambler {
+public:
+    static std::vector<Move> generate(Rng& rng, int length);
+    // Same sequence as entry `index` of batch(seed, ...) with this length.
+    static std::vector<Move> generate(uint64_t seed, size_t index, int length);
+
+    // `count` scrambles and their states, split over `threads` workers (0: one per core).
+    // The result depends only on seed, count and length.
+    static ScrambleBatch batch(uint64_t seed, size_t count, int length, unsigned threads = 0);
+};
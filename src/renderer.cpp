@@ -1,4 +1,5 @@
 #include "renderer.h"
+#include "sequence.h"
 #include <fstream>
 #include <sstream>
 #include <iostream>
@@ -142,39 +143,52 @@ glm::vec3 Renderer::getCubieColor(Cube& cube, int x, int y, int z, int faceDir)
     return faceColor(cube.getFacelet(face, idx));
 }
 
-// Check if a cubie at (x,y,z) belongs to the animated layer
-static bool isInAnimLayer(int x, int y, int z, int animAxis, int animLayer) {
+// Check if a cubie at (x,y,z) belongs to one of the animated layers
+// (animLayers: bit layer+1 per turning layer, so 7 is the whole cube)
+static bool isInAnimLayer(int x, int y, int z, int animAxis, int animLayers) {
     if (animAxis < 0) return false;
     switch (animAxis) {
-    case 0: return x == animLayer; // X axis (L/R)
-    case 1: return y == animLayer; // Y axis (U/D)
-    case 2: return z == animLayer; // Z axis (F/B)
+    case 0: return (animLayers >> (x + 1)) & 1; // X axis (L/M/R)
+    case 1: return (animLayers >> (y + 1)) & 1; // Y axis (U/E/D)
+    case 2: return (animLayers >> (z + 1)) & 1; // Z axis (F/S/B)
     }
     return false;
 }
 
-// Get animation axis and layer for a move
-static void getMoveAxisLayer(Move m, int& axis, int& layer, float& angle) {
+// Get animation axis, layer mask and angle for a move
+static void getMoveAxisLayer(Move m, int& axis, int& layers, float& angle) {
     int idx = static_cast<int>(m);
-    int face = idx / 3;
+    int group = idx / 3;
     int type = idx % 3; // 0=CW, 1=CCW, 2=double
 
     float baseAngle = glm::radians(90.0f);
     if (type == 1) baseAngle = -baseAngle;
     if (type == 2) baseAngle = glm::radians(180.0f);
 
-    switch (face) {
-    case 0: axis = 1; layer =  1; angle = -baseAngle; break; // U
-    case 1: axis = 1; layer = -1; angle =  baseAngle; break; // D
-    case 2: axis = 0; layer = -1; angle =  baseAngle; break; // L
-    case 3: axis = 0; layer =  1; angle = -baseAngle; break; // R
-    case 4: axis = 2; layer =  1; angle = -baseAngle; break; // F
-    case 5: axis = 2; layer = -1; angle =  baseAngle; break; // B
+    switch (group) {
+    case 0:  axis = 1; layers = 4; angle = -baseAngle; break; // U
+    case 1:  axis = 1; layers = 1; angle =  baseAngle; break; // D
+    case 2:  axis = 0; layers = 1; angle =  baseAngle; break; // L
+    case 3:  axis = 0; layers = 4; angle = -baseAngle; break; // R
+    case 4:  axis = 2; layers = 4; angle = -baseAngle; break; // F
+    case 5:  axis = 2; layers = 1; angle =  baseAngle; break; // B
+    case 6:  axis = 0; layers = 2; angle =  baseAngle; break; // M (as L)
+    case 7:  axis = 1; layers = 2; angle =  baseAngle; break; // E (as D)
+    case 8:  axis = 2; layers = 2; angle = -baseAngle; break; // S (as F)
+    case 9:  axis = 1; layers = 6; angle = -baseAngle; break; // u
+    case 10: axis = 1; layers = 3; angle =  baseAngle; break; // d
+    case 11: axis = 0; layers = 3; angle =  baseAngle; break; // l
+    case 12: axis = 0; layers = 6; angle = -baseAngle; break; // r
+    case 13: axis = 2; layers = 6; angle = -baseAngle; break; // f
+    case 14: axis = 2; layers = 3; angle =  baseAngle; break; // b
+    case 15: axis = 0; layers = 7; angle = -baseAngle; break; // x (as R)
+    case 16: axis = 1; layers = 7; angle = -baseAngle; break; // y (as U)
+    case 17: axis = 2; layers = 7; angle = -baseAngle; break; // z (as F)
     }
 }
 
 void Renderer::renderCubie(int x, int y, int z, Cube& cube,
-                           float animAngle, int animAxis, int animLayer) {
+                           float animAngle, int animAxis, int animLayers) {
     // Each cubie is centered at (x, y, z) with half-size slightly less than 0.5
     float hs = 0.47f;      // half-size of cubie body
     float ss = 0.42f;      // half-size of sticker
@@ -192,7 +206,7 @@ void Renderer::renderCubie(int x, int y, int z, Cube& cube,
         // idle state - no animation running
     }
 
-    if (isInAnimLayer(x, y, z, animAxis, animLayer) && animAngle != 0.0f) {
+    if (isInAnimLayer(x, y, z, animAxis, animLayers) && animAngle != 0.0f) {
         glm::vec3 rotAxis(0);
         rotAxis[animAxis] = 1.0f;
         model = model * glm::rotate(glm::mat4(1.0f), animAngle, rotAxis);
@@ -265,14 +279,14 @@ void Renderer::renderCubie(int x, int y, int z, Cube& cube,
 }
 
 void Renderer::renderCube(Cube& cube, float time) {
-    int animAxis = -1, animLayer = 0;
+    int animAxis = -1, animLayers = 0;
     float animAngle = 0.0f;
 
     if (currentAnim_.move != static_cast<Move>(255)) {
-        int axis; int layer; float targetAngle;
-        getMoveAxisLayer(currentAnim_.move, axis, layer, targetAngle);
+        int axis; int layers; float targetAngle;
+        getMoveAxisLayer(currentAnim_.move, axis, layers, targetAngle);
         animAxis = axis;
-        animLayer = layer;
+        animLayers = layers;
 
         // Ease in-out cubic
         float t = currentAnim_.elapsed / currentAnim_.duration;
@@ -285,7 +299,7 @@ void Renderer::renderCube(Cube& cube, float time) {
         for (int y = -1; y <= 1; y++)
             for (int z = -1; z <= 1; z++) {
                 if (x == 0 && y == 0 && z == 0) continue; // skip center
-                renderCubie(x, y, z, cube, animAngle, animAxis, animLayer);
+                renderCubie(x, y, z, cube, animAngle, animAxis, animLayers);
             }
 }
 
@@ -407,11 +421,11 @@ Move Renderer::determineMoveFromDrag(const glm::vec3& start, const glm::vec3& en
             layer = std::clamp(layer, -1, 1);
             if (dx > 0) {
                 if (layer == 1) return Move::F;
-                if (layer == 0) return Move::COUNT; // middle slice, skip
+                if (layer == 0) return Move::S;
                 return Move::Bp;
             } else {
                 if (layer == 1) return Move::Fp;
-                if (layer == 0) return Move::COUNT;
+                if (layer == 0) return Move::Sp;
                 return Move::B;
             }
         } else if (fabsf(dz) > fabsf(dx) * 1.2f) {
@@ -420,11 +434,11 @@ Move Renderer::determineMoveFromDrag(const glm::vec3& start, const glm::vec3& en
             layer = std::clamp(layer, -1, 1);
             if (dz > 0) {
                 if (layer == 1) return Move::Rp;
-                if (layer == 0) return Move::COUNT;
+                if (layer == 0) return Move::M;
                 return Move::L;
             } else {
                 if (layer == 1) return Move::R;
-                if (layer == 0) return Move::COUNT;
+                if (layer == 0) return Move::Mp;
                 return Move::Lp;
             }
         } else {
@@ -438,11 +452,11 @@ Move Renderer::determineMoveFromDrag(const glm::vec3& start, const glm::vec3& en
             layer = std::clamp(layer, -1, 1);
             if (dx > 0) {
                 if (layer == 1) return Move::Fp;
-                if (layer == 0) return Move::COUNT;
+                if (layer == 0) return Move::Sp;
                 return Move::B;
             } else {
                 if (layer == 1) return Move::F;
-                if (layer == 0) return Move::COUNT;
+                if (layer == 0) return Move::S;
                 return Move::Bp;
             }
         } else if (fabsf(dz) > fabsf(dx) * 1.2f) {
@@ -450,11 +464,11 @@ Move Renderer::determineMoveFromDrag(const glm::vec3& start, const glm::vec3& en
             layer = std::clamp(layer, -1, 1);
             if (dz > 0) {
                 if (layer == 1) return Move::R;
-                if (layer == 0) return Move::COUNT;
+                if (layer == 0) return Move::Mp;
                 return Move::Lp;
             } else {
                 if (layer == 1) return Move::Rp;
-                if (layer == 0) return Move::COUNT;
+                if (layer == 0) return Move::M;
                 return Move::L;
             }
         } else {
@@ -468,11 +482,11 @@ Move Renderer::determineMoveFromDrag(const glm::vec3& start, const glm::vec3& en
             layer = std::clamp(layer, -1, 1);
             if (dx > 0) {
                 if (layer == 1) return Move::U;
-                if (layer == 0) return Move::COUNT;
+                if (layer == 0) return Move::Ep;
                 return Move::Dp;
             } else {
                 if (layer == 1) return Move::Up;
-                if (layer == 0) return Move::COUNT;
+                if (layer == 0) return Move::E;
                 return Move::D;
             }
         } else if (fabsf(dy) > fabsf(dx) * 1.2f) {
@@ -480,11 +494,11 @@ Move Renderer::determineMoveFromDrag(const glm::vec3& start, const glm::vec3& en
             layer = std::clamp(layer, -1, 1);
             if (dy > 0) {
                 if (layer == 1) return Move::Rp;
-                if (layer == 0) return Move::COUNT;
+                if (layer == 0) return Move::M;
                 return Move::L;
             } else {
                 if (layer == 1) return Move::R;
-                if (layer == 0) return Move::COUNT;
+                if (layer == 0) return Move::Mp;
                 return Move::Lp;
             }
         } else {
@@ -498,11 +512,11 @@ Move Renderer::determineMoveFromDrag(const glm::vec3& start, const glm::vec3& en
             layer = std::clamp(layer, -1, 1);
             if (dx > 0) {
                 if (layer == 1) return Move::Up;
-                if (layer == 0) return Move::COUNT;
+                if (layer == 0) return Move::E;
                 return Move::D;
             } else {
                 if (layer == 1) return Move::U;
-                if (layer == 0) return Move::COUNT;
+                if (layer == 0) return Move::Ep;
                 return Move::Dp;
             }
         } else if (fabsf(dy) > fabsf(dx) * 1.2f) {
@@ -510,11 +524,11 @@ Move Renderer::determineMoveFromDrag(const glm::vec3& start, const glm::vec3& en
             layer = std::clamp(layer, -1, 1);
             if (dy > 0) {
                 if (layer == -1) return Move::Lp;
-                if (layer == 0) return Move::COUNT;
+                if (layer == 0) return Move::Mp;
                 return Move::R;
             } else {
                 if (layer == -1) return Move::L;
-                if (layer == 0) return Move::COUNT;
+                if (layer == 0) return Move::M;
                 return Move::Rp;
             }
         } else {
@@ -528,11 +542,11 @@ Move Renderer::determineMoveFromDrag(const glm::vec3& start, const glm::vec3& en
             layer = std::clamp(layer, -1, 1);
             if (dz > 0) {
                 if (layer == 1) return Move::Up;
-                if (layer == 0) return Move::COUNT;
+                if (layer == 0) return Move::E;
                 return Move::D;
             } else {
                 if (layer == 1) return Move::U;
-                if (layer == 0) return Move::COUNT;
+                if (layer == 0) return Move::Ep;
                 return Move::Dp;
             }
         } else if (fabsf(dy) > fabsf(dz) * 1.2f) {
@@ -540,11 +554,11 @@ Move Renderer::determineMoveFromDrag(const glm::vec3& start, const glm::vec3& en
             layer = std::clamp(layer, -1, 1);
             if (dy > 0) {
                 if (layer == 1) return Move::F;
-                if (layer == 0) return Move::COUNT;
+                if (layer == 0) return Move::S;
                 return Move::Bp;
             } else {
                 if (layer == 1) return Move::Fp;
-                if (layer == 0) return Move::COUNT;
+                if (layer == 0) return Move::Sp;
                 return Move::B;
             }
         } else {
@@ -558,11 +572,11 @@ Move Renderer::determineMoveFromDrag(const glm::vec3& start, const glm::vec3& en
             layer = std::clamp(layer, -1, 1);
             if (dz > 0) {
                 if (layer == 1) return Move::U;
-                if (layer == 0) return Move::COUNT;
+                if (layer == 0) return Move::Ep;
                 return Move::Dp;
             } else {
                 if (layer == 1) return Move::Up;
-                if (layer == 0) return Move::COUNT;
+                if (layer == 0) return Move::E;
                 return Move::D;
             }
         } else if (fabsf(dy) > fabsf(dz) * 1.2f) {
@@ -570,11 +584,11 @@ Move Renderer::determineMoveFromDrag(const glm::vec3& start, const glm::vec3& en
             layer = std::clamp(layer, -1, 1);
             if (dy > 0) {
                 if (layer == 1) return Move::Fp;
-                if (layer == 0) return Move::COUNT;
+                if (layer == 0) return Move::Sp;
                 return Move::B;
             } else {
                 if (layer == 1) return Move::F;
-                if (layer == 0) return Move::COUNT;
+                if (layer == 0) return Move::S;
                 return Move::Bp;
             }
         } else {
@@ -596,20 +610,41 @@ void Renderer::queueMove(Move m, Cube& cube) {
         statusText_ = "Solving... (press SOLVE again to cancel)";
         return;
     }
-    moveQueue_.push(m);
+    enqueueMoves({m});
+}
+
+// Appends to the playback queue and re-simplifies everything not yet animating, so
+// R followed by R' never plays and U U collapses into one U2 animation.
+void Renderer::enqueueMoves(const std::vector<Move>& moves) {
+    std::vector<Move> pending(moveQueue_.begin(), moveQueue_.end());
+    pending.insert(pending.end(), moves.begin(), moves.end());
+    pending = MoveSequence::simplified(pending);
+    moveQueue_.assign(pending.begin(), pending.end());
 }
 
 void Renderer::processKeyboard(Cube& cube, int key, int action, int mods) {
     if (action != GLFW_PRESS) return;
     bool shift = (mods & GLFW_MOD_SHIFT) != 0;
+    bool wide = (mods & GLFW_MOD_CONTROL) != 0;
+    // CW/CCW pair of the outer (or, with Ctrl, wide) move; Shift picks the CCW one.
+    auto turn = [&](Move outer, Move outerWide) {
+        Move m = wide ? outerWide : outer;
+        queueMove(static_cast<Move>(static_cast<int>(m) + (shift ? 1 : 0)), cube);
+    };
 
     switch (key) {
-    case GLFW_KEY_U: queueMove(shift ? Move::Up : Move::U, cube); break;
-    case GLFW_KEY_D: queueMove(shift ? Move::Dp : Move::D, cube); break;
-    case GLFW_KEY_L: queueMove(shift ? Move::Lp : Move::L, cube); break;
-    case GLFW_KEY_R: queueMove(shift ? Move::Rp : Move::R, cube); break;
-    case GLFW_KEY_F: queueMove(shift ? Move::Fp : Move::F, cube); break;
-    case GLFW_KEY_B: queueMove(shift ? Move::Bp : Move::B, cube); break;
+    case GLFW_KEY_U: turn(Move::U, Move::Uw); break;
+    case GLFW_KEY_D: turn(Move::D, Move::Dw); break;
+    case GLFW_KEY_L: turn(Move::L, Move::Lw); break;
+    case GLFW_KEY_R: turn(Move::R, Move::Rw); break;
+    case GLFW_KEY_F: turn(Move::F, Move::Fw); break;
+    case GLFW_KEY_B: turn(Move::B, Move::Bw); break;
+    case GLFW_KEY_M: queueMove(shift ? Move::Mp : Move::M, cube); break;
+    case GLFW_KEY_E: queueMove(shift ? Move::Ep : Move::E, cube); break;
+    case GLFW_KEY_S: queueMove(shift ? Move::Sp : Move::S, cube); break;
+    case GLFW_KEY_X: queueMove(shift ? Move::xp : Move::x, cube); break;
+    case GLFW_KEY_Y: queueMove(shift ? Move::yp : Move::y, cube); break;
+    case GLFW_KEY_Z: queueMove(shift ? Move::zp : Move::z, cube); break;
     case GLFW_KEY_SPACE:
         requestCancelSolve();
         cube.scramble(10);
@@ -620,7 +655,7 @@ void Renderer::processKeyboard(Cube& cube, int key, int action, int mods) {
         requestCancelSolve();
         cube.reset();
         // Clear any pending moves
-        while (!moveQueue_.empty()) moveQueue_.pop();
+        moveQueue_.clear();
         currentAnim_.move = static_cast<Move>(255);
         statusText_ = "";
         break;
@@ -920,8 +955,12 @@ void Renderer::renderHUD(Cube& cube) {
         }
     }
 
+    // Progress: stickers matching their centre (kept incrementally by the cube).
+    font_.renderText("Stickers in place: " + std::to_string(54 - cube.misplacedCount()) + "/54",
+                     10, 25, 1.8f, {0.6f, 0.7f, 0.8f}, width_, height_);
+
     // Help text at bottom
-    font_.renderText("RMB:Camera  LMB:Drag face  U/D/L/R/F/B:Moves  Shift:Reverse",
+    font_.renderText("RMB:Camera  LMB:Drag layer  U/D/L/R/F/B M/E/S X/Y/Z:Moves  Ctrl:Wide  Shift:Reverse",
                      10, 5, 1.8f, {0.5f, 0.5f, 0.6f}, width_, height_);
 }
 
@@ -948,7 +987,7 @@ bool Renderer::handleButtonClick(double x, double y, Cube& cube) {
     if (btnReset_.contains(mx, my)) {
         requestCancelSolve();
         cube.reset();
-        while (!moveQueue_.empty()) moveQueue_.pop();
+        moveQueue_.clear();
         currentAnim_.move = static_cast<Move>(255);
         statusText_ = "";
         return true;
@@ -987,7 +1026,7 @@ void Renderer::run(Cube& cube, std::function<std::vector<Move>(Cube&, std::atomi
                 } else if (solution.empty()) {
                     statusText_ = cube.isSolved() ? "Solved" : "No state solution found";
                 } else {
-                    for (auto m : solution) moveQueue_.push(m);
+                    enqueueMoves(solution);
                     statusText_ = "Solution: " + std::to_string(solution.size()) + " moves";
                 }
             } else {
@@ -1011,7 +1050,7 @@ void Renderer::run(Cube& cube, std::function<std::vector<Move>(Cube&, std::atomi
             }
         } else if (!moveQueue_.empty()) {
             currentAnim_.move = moveQueue_.front();
-            moveQueue_.pop();
+            moveQueue_.pop_front();
             currentAnim_.elapsed = 0.0f;
             currentAnim_.duration = 0.3f;
         }
@@ -6,7 +6,7 @@
 #include <glm/gtc/type_ptr.hpp>
 #include <string>
 #include <vector>
-#include <queue>
+#include <deque>
 #include <functional>
 #include <future>
 #include <chrono>
@@ -65,7 +65,7 @@ private:
 
     // Animation
     MoveAnimation currentAnim_;
-    std::queue<Move> moveQueue_;
+    std::deque<Move> moveQueue_;  // pending moves, kept simplified (see enqueueMoves)
 
     // HUD
     Font font_;
@@ -92,7 +92,7 @@ private:
 
     void renderBackground();
     void renderCube(Cube& cube, float time);
-    void renderCubie(int x, int y, int z, Cube& cube, float animAngle, int animAxis, int animLayer);
+    void renderCubie(int x, int y, int z, Cube& cube, float animAngle, int animAxis, int animLayers);
     void renderHUD(Cube& cube);
     void renderButton(const Button& btn);
 
@@ -119,4 +119,5 @@ private:
                                int face, const glm::vec3& normal);
 
     void queueMove(Move m, Cube& cube);
+    void enqueueMoves(const std::vector<Move>& moves);
 };
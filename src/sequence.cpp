@@ -0,0 +1,94 @@
+#include "sequence.h"
+
+#include <algorithm>
+
+namespace {
+// Groups of three moves (U, D, L, R, F, B, M, E, S, u, d, l, r, f, b, x, y, z) by turning axis.
+constexpr int kGroupAxis[18] = {1, 1, 0, 0, 2, 2, 0, 1, 2, 1, 1, 0, 0, 2, 2, 0, 1, 2};
+
+int groupOf(Move m) {
+    return static_cast<int>(m) / 3;
+}
+
+// Clockwise quarter turns: CW = 1, CCW = 3, half = 2.
+int quarterTurns(Move m) {
+    constexpr int turns[3] = {1, 3, 2};
+    return turns[static_cast<int>(m) % 3];
+}
+
+Move withTurns(int group, int quarters) {
+    constexpr int type[4] = {-1, 0, 2, 1};
+    return static_cast<Move>(group * 3 + type[quarters]);
+}
+}
+
+MoveSequence::MoveSequence(std::vector<Move> moves) : moves_(std::move(moves)) {}
+
+void MoveSequence::push(Move m) {
+    moves_.push_back(m);
+    fusedValid_ = false;
+}
+
+void MoveSequence::append(const std::vector<Move>& moves) {
+    moves_.insert(moves_.end(), moves.begin(), moves.end());
+    fusedValid_ = false;
+}
+
+void MoveSequence::simplify() {
+    moves_ = simplified(moves_);
+    fusedValid_ = false;
+}
+
+std::vector<Move> MoveSequence::simplified(const std::vector<Move>& moves) {
+    // The tail of `out` after `runStart` is always one canonical same-axis run; dropping a
+    // move can empty it, and the run before then becomes the tail.
+    std::vector<Move> out;
+    out.reserve(moves.size());
+    for (Move m : moves) {
+        if (m == Move::COUNT) continue;
+        int group = groupOf(m);
+        int axis = kGroupAxis[group];
+
+        size_t runStart = out.size();
+        while (runStart > 0 && kGroupAxis[groupOf(out[runStart - 1])] == axis) runStart--;
+
+        auto pos = std::lower_bound(out.begin() + runStart, out.end(), m,
+                                    [](Move a, Move b) { return groupOf(a) < groupOf(b); });
+        if (pos != out.end() && groupOf(*pos) == group) {
+            int quarters = (quarterTurns(*pos) + quarterTurns(m)) % 4;
+            if (quarters == 0) out.erase(pos);
+            else *pos = withTurns(group, quarters);
+        } else {
+            out.insert(pos, m);
+        }
+    }
+    return out;
+}
+
+const FaceletGather& MoveSequence::fused() const {
+    if (!fusedValid_) {
+        // After a then b, facelet i holds the sticker from a[b[i]]: gathering the index
+        // array through each move in order composes the permutations.
+        std::array<uint8_t, 54> index;
+        for (int i = 0; i < 54; i++) index[i] = static_cast<uint8_t>(i);
+        for (Move m : moves_) {
+            if (m == Move::COUNT) continue;
+            std::array<uint8_t, 54> next;
+            const auto& perm = Cube::movePermutation(m);
+            for (int i = 0; i < 54; i++) next[i] = index[perm[i]];
+            index = next;
+        }
+        fused_ = FaceletGather(index);
+        fusedValid_ = true;
+    }
+    return fused_;
+}
+
+void MoveSequence::applyTo(Cube& cube) const {
+    cube.applyGather(fused());
+}
+
+void MoveSequence::applyTo(std::vector<Cube>& cubes) const {
+    const FaceletGather& gather = fused();
+    for (Cube& cube : cubes) cube.applyGather(gather);
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include "cube.h"
+#include "facelet_gather.h"
+#include <vector>
+
+// A move sequence that can be fused into a single facelet permutation.
+//
+// The fused gather is built on first use (one gather per move, applied to the identity
+// index array) and then reused, so applying a long sequence to many cubes costs one
+// 54-byte gather per cube instead of one per move.
+class MoveSequence {
+public:
+    MoveSequence() = default;
+    explicit MoveSequence(std::vector<Move> moves);
+
+    const std::vector<Move>& moves() const { return moves_; }
+    size_t size() const { return moves_.size(); }
+    bool empty() const { return moves_.empty(); }
+
+    void push(Move m);
+    void append(const std::vector<Move>& moves);
+
+    // Rewrites the sequence in place with simplified(); the result is the same permutation.
+    void simplify();
+
+    // Shortest form reachable by local rewrites: runs of moves on one axis commute, so
+    // within each run turns of the same face or slice are merged (U U2 -> U', R R' -> ""),
+    // and the survivors are put in Move order (D U -> U D). Skips Move::COUNT entries.
+    static std::vector<Move> simplified(const std::vector<Move>& moves);
+
+    // Composed permutation of the whole sequence (gather form, like Cube::movePermutation).
+    const FaceletGather& fused() const;
+
+    void applyTo(Cube& cube) const;
+    void applyTo(std::vector<Cube>& cubes) const;
+
+private:
+    std::vector<Move> moves_;
+    mutable FaceletGather fused_;
+    mutable bool fusedValid_ = false;
+};
@@ -1,40 +1,153 @@
 #include "solver.h"
+#include "move_automaton.h"
+#include "optimal.h"
+#include "sequence.h"
+#include "thread_pool.h"
+#include "two_phase.h"
 
-#include <array>
-#include <string>
-#include <unordered_map>
+#include <algorithm>
+#include <mutex>
 
 namespace {
 
-constexpr int kMoves = static_cast<int>(Move::COUNT);
-constexpr int kHalfDepth = 5;
+constexpr size_t kChunk = 512;  // frontier nodes per pool task
 
+constexpr uint8_t kRoot = 0xFF;  // "last move" of the state a side starts from
+
+// The moves a bidirectional search turns, their canonical-order automaton, and how many
+// layers each side expands (solutions up to twice that long are found).
+struct MoveSet {
+    int start;
+    uint32_t (*allowed)(int);
+    int (*next)(Move);
+    int halfDepth;
+    double growth;  // new states per frontier node (at most, measured over the full search)
+};
+
+constexpr MoveSet kFaceTurns{MoveAutomaton::kStart, MoveAutomaton::allowed, MoveAutomaton::next, 5, 13.5};
+// Nine more moves widen every layer; one layer fewer keeps a failed search under a second.
+constexpr MoveSet kSliceTurns{MoveAutomaton::kSliceStart, MoveAutomaton::allowedSlice, MoveAutomaton::nextSlice, 4, 18.6};
+
+// A frontier entry is the state plus the move that reached it; the path itself is only
+// rebuilt, from the visited sets, for the state where the two sides meet.
 struct Node {
-    std::array<Color, 54> state{};
-    std::vector<Move> path;
-    int lastFace = -1;
+    PackedCube state;
+    uint8_t lastMove = kRoot;
+
+    int automaton(const MoveSet& moves) const {
+        return lastMove == kRoot ? moves.start : moves.next(static_cast<Move>(lastMove));
+    }
 };
 
-std::string keyOf(const std::array<Color, 54>& state) {
-    std::string key(state.size(), '\0');
-    for (size_t i = 0; i < state.size(); i++) key[i] = static_cast<char>(state[i]);
-    return key;
-}
+// Visited states with the move that first reached each, split by hash into independently
+// locked shards so workers expanding one layer rarely wait on each other. The other side's
+// set is only read during a layer and needs no locking.
+//
+// Each shard is an open-addressing table holding the 16-byte key and the move byte inline,
+// at most 80% full: about 21 bytes per state once reserve() has sized it for the layer.
+class SeenSet {
+public:
+    static constexpr int kShardBits = 6;
+    static constexpr size_t kShards = size_t(1) << kShardBits;
 
-int faceOf(Move move) {
-    return static_cast<int>(move) / 3;
-}
+    // Room for `count` more states, so the coming layer inserts without rehashing. Not
+    // safe while another thread inserts.
+    void reserve(size_t count) {
+        for (Shard& shard : shards_) shard.reserve(shard.size + count / kShards + count / kShards / 32 + 16);
+    }
 
-bool allowed(Move move, int lastFace) {
-    return faceOf(move) != lastFace;
-}
+    // False when `key` was already present.
+    bool insert(const PackedCube& key, uint8_t lastMove) {
+        Shard& shard = shardOf(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.insert(key, lastMove);
+    }
 
-std::array<Color, 54> moved(const std::array<Color, 54>& state, Move move) {
-    Cube cube;
-    cube.setState(state);
-    cube.applyMove(move);
-    return cube.getState();
-}
+    bool contains(const PackedCube& key) const { return shardOf(key).find(key) != Shard::kMissing; }
+
+    size_t size() const {
+        size_t total = 0;
+        for (const Shard& shard : shards_) total += shard.size;
+        return total;
+    }
+
+    // Moves from this side's root to `key`, found by undoing last moves back to the root.
+    // Not safe while another thread inserts.
+    std::vector<Move> path(PackedCube key) const {
+        std::vector<Move> out;
+        for (uint8_t m = lastMove(key); m != kRoot; m = lastMove(key)) {
+            out.push_back(static_cast<Move>(m));
+            CubieCube parent = CubieCube::unpack(key);
+            parent.applyMove(Cube::inverseMove(static_cast<Move>(m)));
+            key = parent.pack();
+        }
+        std::reverse(out.begin(), out.end());
+        return out;
+    }
+
+private:
+    // Linear probing from a slot picked by the low hash bits (the shard used the top ones).
+    // The all-zero key marks an empty slot; no valid state packs to it.
+    struct Shard {
+        static constexpr size_t kMissing = ~size_t(0);
+
+        std::mutex mutex;
+        std::vector<PackedCube> keys;
+        std::vector<uint8_t> moves;
+        size_t size = 0;
+
+        // Slot holding `key`, or the empty slot where it would go.
+        size_t slot(const PackedCube& key) const {
+            size_t i = static_cast<size_t>((key.hash() & 0xFFFFFFFFu) * keys.size() >> 32);
+            while (keys[i] != key && keys[i] != PackedCube{}) {
+                if (++i == keys.size()) i = 0;
+            }
+            return i;
+        }
+
+        size_t find(const PackedCube& key) const {
+            if (keys.empty()) return kMissing;
+            size_t i = slot(key);
+            return keys[i] == key ? i : kMissing;
+        }
+
+        bool insert(const PackedCube& key, uint8_t lastMove) {
+            if ((size + 1) * 5 > keys.size() * 4) reserve(std::max<size_t>(64, size * 2));
+            size_t i = slot(key);
+            if (keys[i] == key) return false;
+            keys[i] = key;
+            moves[i] = lastMove;
+            size++;
+            return true;
+        }
+
+        void reserve(size_t count) {
+            size_t capacity = count + count / 4 + 1;
+            if (capacity <= keys.size()) return;
+            std::vector<PackedCube> oldKeys(capacity);
+            std::vector<uint8_t> oldMoves(capacity);
+            oldKeys.swap(keys);
+            oldMoves.swap(moves);
+            for (size_t j = 0; j < oldKeys.size(); j++) {
+                if (oldKeys[j] == PackedCube{}) continue;
+                size_t i = slot(oldKeys[j]);
+                keys[i] = oldKeys[j];
+                moves[i] = oldMoves[j];
+            }
+        }
+    };
+
+    uint8_t lastMove(const PackedCube& key) const {
+        const Shard& shard = shardOf(key);
+        return shard.moves[shard.find(key)];
+    }
+
+    // Top bits pick the shard; the slots come from the low bits.
+    Shard& shardOf(const PackedCube& key) { return shards_[key.hash() >> (64 - kShardBits)]; }
+    const Shard& shardOf(const PackedCube& key) const { return shards_[key.hash() >> (64 - kShardBits)]; }
+
+    Shard shards_[kShards];
+};
 
 std::vector<Move> inverted(const std::vector<Move>& path) {
     std::vector<Move> out;
@@ -43,49 +156,71 @@ std::vector<Move> inverted(const std::vector<Move>& path) {
     return out;
 }
 
+// The seam between the two halves can hold mergeable turns (R R', U U2); simplify them away.
 std::vector<Move> joined(const std::vector<Move>& fromStart, const std::vector<Move>& fromSolved) {
     auto tail = inverted(fromSolved);
     std::vector<Move> out = fromStart;
     out.insert(out.end(), tail.begin(), tail.end());
-    return out;
+    return MoveSequence::simplified(out);
 }
 
-bool expand(std::vector<Node>& frontier,
-            std::unordered_map<std::string, std::vector<Move>>& own,
-            const std::unordered_map<std::string, std::vector<Move>>& other,
-            bool startSide,
-            std::vector<Move>& solution,
+// One BFS layer. Chunks of the frontier are expanded on the pool, each worker filling its
+// own next-layer buffer; the buffers are concatenated once the layer is done. Within a
+// layer every meet gives the same (shortest) length, so the first one found is kept in
+// `meet`.
+bool expand(WorkStealingPool& pool,
+            const MoveSet& moveSet,
+            std::vector<Node>& frontier,
+            SeenSet& own,
+            const SeenSet& other,
+            PackedCube& meet,
             std::atomic_bool* cancel,
             SolverProgress* progress) {
-    std::vector<Node> next;
-    next.reserve(frontier.size() * 12);
-    for (const auto& node : frontier) {
-        if (cancel && cancel->load(std::memory_order_relaxed)) return false;
-        for (int i = 0; i < kMoves; i++) {
-            Move move = static_cast<Move>(i);
-            if (!allowed(move, node.lastFace)) continue;
-
-            Node child;
-            child.state = moved(node.state, move);
-            child.path = node.path;
-            child.path.push_back(move);
-            child.lastFace = faceOf(move);
-
-            std::string key = keyOf(child.state);
-            if (own.find(key) != own.end()) continue;
-            if (progress) progress->nodes.fetch_add(1, std::memory_order_relaxed);
-
-            auto meet = other.find(key);
-            if (meet != other.end()) {
-                solution = startSide ? joined(child.path, meet->second) : joined(meet->second, child.path);
-                return true;
+    own.reserve(static_cast<size_t>(static_cast<double>(frontier.size()) * moveSet.growth));
+    std::vector<std::vector<Node>> next(pool.size());
+    std::atomic_bool stop{false};
+    std::mutex meetMutex;
+    bool met = false;
+
+    size_t tasks = (frontier.size() + kChunk - 1) / kChunk;
+    pool.run(tasks, [&](size_t task, unsigned worker) {
+        size_t end = std::min(frontier.size(), (task + 1) * kChunk);
+        uint64_t nodes = 0;
+        for (size_t i = task * kChunk; i < end && !stop.load(std::memory_order_relaxed); i++) {
+            if (cancel && cancel->load(std::memory_order_relaxed)) {
+                stop.store(true, std::memory_order_relaxed);
+                break;
             }
+            const Node& node = frontier[i];
+            CubieCube state = CubieCube::unpack(node.state);
+            for (uint32_t moves = moveSet.allowed(node.automaton(moveSet)); moves; moves &= moves - 1) {
+                int m = __builtin_ctz(moves);
+                CubieCube child = state;
+                child.applyMove(static_cast<Move>(m));
 
-            own.emplace(key, child.path);
-            next.push_back(std::move(child));
+                PackedCube key = child.pack();
+                if (!own.insert(key, static_cast<uint8_t>(m))) continue;
+                nodes++;
+
+                if (other.contains(key)) {
+                    std::lock_guard<std::mutex> lock(meetMutex);
+                    if (!met) meet = key;
+                    met = true;
+                    stop.store(true, std::memory_order_relaxed);
+                    break;
+                }
+                next[worker].push_back({key, static_cast<uint8_t>(m)});
+            }
         }
-    }
-    frontier = std::move(next);
+        if (progress) progress->nodes.fetch_add(nodes, std::memory_order_relaxed);
+    });
+    if (met || stop.load()) return met;
+
+    size_t total = 0;
+    for (const auto& buffer : next) total += buffer.size();
+    frontier.clear();
+    frontier.reserve(total);
+    for (auto& buffer : next) frontier.insert(frontier.end(), buffer.begin(), buffer.end());
     return false;
 }
 
@@ -101,23 +236,39 @@ std::vector<Move> Solver::solve(Cube& cube, std::atomic_bool* cancel, SolverProg
         progress->depth.store(0, std::memory_order_relaxed);
     }
     if (cube.isSolved() || !cube.isSolvable() || (cancel && cancel->load(std::memory_order_relaxed))) return {};
+    if (method_ == SolverMethod::TwoPhase) return TwoPhaseSolver::solve(cube.cubies(), cancel, progress);
+    if (method_ == SolverMethod::Optimal) {
+        return OptimalSolver::solve(cube.cubies(), cancel, progress, OptimalSolver::kMaxLength, threads_);
+    }
+    return solveBidirectional(cube, cancel, progress);
+}
 
-    Cube solved;
-    solved.reset();
-
-    std::unordered_map<std::string, std::vector<Move>> startSeen;
-    std::unordered_map<std::string, std::vector<Move>> solvedSeen;
-    std::vector<Node> startFrontier = {{cube.getState(), {}, -1}};
-    std::vector<Node> solvedFrontier = {{solved.getState(), {}, -1}};
-    startSeen.emplace(keyOf(cube.getState()), std::vector<Move>{});
-    solvedSeen.emplace(keyOf(solved.getState()), std::vector<Move>{});
+// The search runs on Cube::cubies(), which is read relative to the centres, so a slice move
+// is just another transition of that state (CubieCube::applyMove) and a solved reading is a
+// solved cube in whatever orientation the slices leave it.
+std::vector<Move> Solver::solveBidirectional(Cube& cube, std::atomic_bool* cancel, SolverProgress* progress) {
+    const MoveSet& moveSet = method_ == SolverMethod::BidirectionalSlice ? kSliceTurns : kFaceTurns;
+    WorkStealingPool pool(threads_);
+    SeenSet startSeen;
+    SeenSet solvedSeen;
+    std::vector<Node> startFrontier = {{cube.packed(), kRoot}};
+    std::vector<Node> solvedFrontier = {{CubieCube().pack(), kRoot}};
+    startSeen.insert(startFrontier[0].state, kRoot);
+    solvedSeen.insert(solvedFrontier[0].state, kRoot);
 
-    std::vector<Move> solution;
-    for (int depth = 0; depth < kHalfDepth; depth++) {
+    auto cancelled = [cancel] { return cancel && cancel->load(std::memory_order_relaxed); };
+    PackedCube meet;
+    for (int depth = 0; depth < moveSet.halfDepth; depth++) {
         if (progress) progress->depth.store(depth * 2, std::memory_order_relaxed);
-        if (expand(startFrontier, startSeen, solvedSeen, true, solution, cancel, progress)) return solution;
-        if (progress) progress->depth.store(depth * 2 + 1, std::memory_order_relaxed);
-        if (expand(solvedFrontier, solvedSeen, startSeen, false, solution, cancel, progress)) return solution;
+        bool met = expand(pool, moveSet, startFrontier, startSeen, solvedSeen, meet, cancel, progress);
+        if (cancelled()) return {};
+        if (!met) {
+            if (progress) progress->depth.store(depth * 2 + 1, std::memory_order_relaxed);
+            met = expand(pool, moveSet, solvedFrontier, solvedSeen, startSeen, meet, cancel, progress);
+            if (cancelled()) return {};
+        }
+        // Both sets are complete up to the meet, and no thread writes them any more.
+        if (met) return joined(startSeen.path(meet), solvedSeen.path(meet));
     }
     return {};
 }
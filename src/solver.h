@@ -9,8 +9,28 @@ struct SolverProgress {
     std::atomic<int> depth{0};
 };
 
+enum class SolverMethod {
+    TwoPhase,            // Kociemba two-phase search (see TwoPhaseSolver): any state, ~20-22 moves
+    Bidirectional,       // optimal meet-in-the-middle BFS; only finds solutions up to 10 moves
+    Optimal,             // IDA* with pattern databases (see OptimalSolver): shortest, but slow when deep
+    BidirectionalSlice,  // Bidirectional with M/E/S as single moves (slice turn metric); up to 8 moves
+};
+
 class Solver {
 public:
+    // `threads` bounds the workers of the Bidirectional and Optimal searches (0: one per core).
+    explicit Solver(SolverMethod method = SolverMethod::TwoPhase, unsigned threads = 0)
+        : method_(method), threads_(threads) {}
+
+    SolverMethod method() const { return method_; }
+    unsigned threads() const { return threads_; }
+
     std::vector<Move> solve(Cube& cube);
     std::vector<Move> solve(Cube& cube, std::atomic_bool* cancel, SolverProgress* progress = nullptr);
+
+private:
+    std::vector<Move> solveBidirectional(Cube& cube, std::atomic_bool* cancel, SolverProgress* progress);
+
+    SolverMethod method_;
+    unsigned threads_;
 };
@@ -0,0 +1,179 @@
+#include "symmetry.h"
+#include "coord.h"
+
+#include <array>
+
+namespace {
+CubieCube makeCubie(const std::array<uint8_t, 8>& cp, const std::array<uint8_t, 8>& co,
+                    const std::array<uint8_t, 12>& ep, const std::array<uint8_t, 12>& eo) {
+    CubieCube c;
+    c.cp = cp;
+    c.co = co;
+    c.ep = ep;
+    c.eo = eo;
+    return c;
+}
+
+struct SymTables {
+    std::array<CubieCube, Symmetry::kCount> cubes;
+    std::array<int, Symmetry::kCount> inverse{};
+    std::array<std::array<Move, kFaceMoves>, Symmetry::kCount> moveConj{};
+    std::vector<uint16_t> cornerPermConj;  // [cornerPerm * kCount + s]
+    std::vector<uint16_t> twistConj;       // [twist * kUDCount + s]
+
+    SymTables() {
+        // Basic symmetries in cubie form (corner order URF, UFL, ULB, UBR, DFR, DLF, DBL, DRB;
+        // edge order UR, UF, UL, UB, DR, DF, DL, DB, FR, FL, BL, BR).
+        // 120 degree turn about the URF-DBL diagonal.
+        const CubieCube kRotUrf3 = makeCubie({0, 4, 5, 1, 3, 7, 6, 2}, {1, 2, 1, 2, 2, 1, 2, 1},
+                                             {1, 8, 5, 9, 3, 11, 7, 10, 0, 4, 6, 2},
+                                             {1, 0, 1, 0, 1, 0, 1, 0, 1, 1, 1, 1});
+        // 180 degree turn about the F-B axis.
+        const CubieCube kRotF2 = makeCubie({5, 4, 7, 6, 1, 0, 3, 2}, {0, 0, 0, 0, 0, 0, 0, 0},
+                                           {6, 5, 4, 7, 2, 1, 0, 3, 9, 8, 11, 10},
+                                           {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0});
+        // 90 degree turn about the U-D axis.
+        const CubieCube kRotU4 = makeCubie({3, 0, 1, 2, 7, 4, 5, 6}, {0, 0, 0, 0, 0, 0, 0, 0},
+                                           {3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10},
+                                           {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1});
+        // Reflection in the plane through the U, D, F and B centres.
+        const CubieCube kMirrLr2 = makeCubie({1, 0, 3, 2, 5, 4, 7, 6}, {3, 3, 3, 3, 3, 3, 3, 3},
+                                             {2, 1, 0, 3, 6, 5, 4, 7, 9, 8, 11, 10},
+                                             {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0});
+
+        CubieCube c;
+        int idx = 0;
+        for (int urf3 = 0; urf3 < 3; urf3++) {
+            for (int f2 = 0; f2 < 2; f2++) {
+                for (int u4 = 0; u4 < 4; u4++) {
+                    for (int lr2 = 0; lr2 < 2; lr2++) {
+                        cubes[idx++] = c;
+                        c = c * kMirrLr2;
+                    }
+                    c = c * kRotU4;
+                }
+                c = c * kRotF2;
+            }
+            c = c * kRotUrf3;
+        }
+
+        for (int s = 0; s < Symmetry::kCount; s++) {
+            for (int t = 0; t < Symmetry::kCount; t++) {
+                if ((cubes[s] * cubes[t]).isSolved()) {
+                    inverse[s] = t;
+                    break;
+                }
+            }
+        }
+
+        constexpr int kMoves = kFaceMoves;
+        std::array<CubieCube, kMoves> moveCubes;
+        for (int m = 0; m < kMoves; m++) moveCubes[m] = CubieCube::fromMoves({static_cast<Move>(m)});
+        for (int s = 0; s < Symmetry::kCount; s++) {
+            for (int m = 0; m < kMoves; m++) {
+                CubieCube conj = cubes[inverse[s]] * moveCubes[m] * cubes[s];
+                for (int k = 0; k < kMoves; k++) {
+                    if (moveCubes[k] == conj) {
+                        moveConj[s][m] = static_cast<Move>(k);
+                        break;
+                    }
+                }
+            }
+        }
+
+        cornerPermConj.resize(static_cast<size_t>(CoordTables::kCornerPerm) * Symmetry::kCount);
+        for (int p = 0; p < CoordTables::kCornerPerm; p++) {
+            CubieCube cc;
+            cc.setCornerPerm(p);
+            for (int s = 0; s < Symmetry::kCount; s++) {
+                // Permutation part of S^-1 * cc * S, without the orientation bookkeeping.
+                const CubieCube& sym = cubes[s];
+                const CubieCube& inv = cubes[inverse[s]];
+                CubieCube conj;
+                for (int i = 0; i < 8; i++) conj.cp[i] = inv.cp[cc.cp[sym.cp[i]]];
+                cornerPermConj[static_cast<size_t>(p) * Symmetry::kCount + s] =
+                    static_cast<uint16_t>(conj.cornerPerm());
+            }
+        }
+
+        twistConj.resize(static_cast<size_t>(CoordTables::kTwist) * Symmetry::kUDCount);
+        for (int t = 0; t < CoordTables::kTwist; t++) {
+            CubieCube cc;
+            cc.setTwist(t);
+            for (int s = 0; s < Symmetry::kUDCount; s++) {
+                CubieCube conj = cubes[inverse[s]] * cc * cubes[s];
+                twistConj[static_cast<size_t>(t) * Symmetry::kUDCount + s] = static_cast<uint16_t>(conj.twist());
+            }
+        }
+    }
+};
+
+const SymTables& tables() {
+    static const SymTables t;
+    return t;
+}
+
+bool packedLess(const PackedCube& a, const PackedCube& b) {
+    return a.hi != b.hi ? a.hi < b.hi : a.lo < b.lo;
+}
+}
+
+const CubieCube& Symmetry::cube(int s) {
+    return tables().cubes[s];
+}
+
+int Symmetry::inverse(int s) {
+    return tables().inverse[s];
+}
+
+CubieCube Symmetry::conjugate(const CubieCube& c, int s) {
+    const SymTables& t = tables();
+    return t.cubes[t.inverse[s]] * c * t.cubes[s];
+}
+
+Move Symmetry::conjugateMove(Move m, int s) {
+    if (!isFaceMove(m)) return Move::COUNT;
+    return tables().moveConj[s][static_cast<int>(m)];
+}
+
+PackedCube Symmetry::canonical(const CubieCube& c, int* symOut) {
+    const SymTables& t = tables();
+    const uint16_t* conj = &t.cornerPermConj[static_cast<size_t>(c.cornerPerm()) * kCount];
+
+    uint16_t bestCorner = conj[0];
+    for (int s = 1; s < kCount; s++) {
+        if (conj[s] < bestCorner) bestCorner = conj[s];
+    }
+
+    bool found = false;
+    PackedCube best;
+    int bestSym = 0;
+    for (int s = 0; s < kCount; s++) {
+        if (conj[s] != bestCorner) continue;
+        PackedCube p = conjugate(c, s).pack();
+        if (!found || packedLess(p, best)) {
+            best = p;
+            bestSym = s;
+            found = true;
+        }
+    }
+    if (symOut) *symOut = bestSym;
+    return best;
+}
+
+std::vector<Move> Symmetry::mapSolution(const std::vector<Move>& moves, int s) {
+    // conjugate(c, s) * M = id  =>  c * (S M S^-1) = id, i.e. conjugate each move by S^-1.
+    int inv = inverse(s);
+    std::vector<Move> out;
+    out.reserve(moves.size());
+    for (Move m : moves) out.push_back(conjugateMove(m, inv));
+    return out;
+}
+
+int Symmetry::cornerPermConj(int cornerPerm, int s) {
+    return tables().cornerPermConj[static_cast<size_t>(cornerPerm) * kCount + s];
+}
+
+int Symmetry::twistConj(int twist, int s) {
+    return tables().twistConj[static_cast<size_t>(twist) * kUDCount + s];
+}
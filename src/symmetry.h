@@ -0,0 +1,37 @@
+#pragma once
+#include "cube.h"
+#include <cstdint>
+#include <vector>
+
+// The 48 symmetries of the cube: 24 rotations, each optionally followed by the
+// left-right reflection. Indexed as 16*urf3 + 8*f2 + 2*u4 + lr2 (Kociemba's order), so
+// indices below kUDCount are the 16 symmetries that keep the U-D axis in place.
+//
+// Conjugating a state by a symmetry relabels it without changing its distance to solved,
+// so searches and caches can work on one canonical representative per class and map
+// solutions back with mapSolution.
+class Symmetry {
+public:
+    static constexpr int kCount = 48;
+    static constexpr int kUDCount = 16;
+
+    static const CubieCube& cube(int s);
+    static int inverse(int s);
+
+    // S^-1 * c * S for S = cube(s). Valid states stay valid (mirrored twists cancel out).
+    static CubieCube conjugate(const CubieCube& c, int s);
+    // The face move equal to S^-1 * m * S; Move::COUNT for slice, wide and rotation moves.
+    static Move conjugateMove(Move m, int s);
+
+    // Canonical representative of c's symmetry class. Candidates are narrowed by the
+    // corner-permutation conjugation table and ties broken on the packed state. When
+    // `symOut` is given it receives s with canonical == conjugate(c, s).
+    static PackedCube canonical(const CubieCube& c, int* symOut = nullptr);
+
+    // Turns a solution of conjugate(c, s) into a solution of c.
+    static std::vector<Move> mapSolution(const std::vector<Move>& moves, int s);
+
+    // Coordinate conjugation tables (same S^-1 * c * S convention).
+    static int cornerPermConj(int cornerPerm, int s);    // all 48 symmetries
+    static int twistConj(int twist, int s);              // s < kUDCount only
+};
@@ -0,0 +1,86 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+
+WorkStealingPool::WorkStealingPool(unsigned threads) {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned w = 0; w < threads; w++) queues_.push_back(std::make_unique<Queue>());
+    for (unsigned w = 1; w < threads; w++) threads_.emplace_back(&WorkStealingPool::workerLoop, this, w);
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        quit_ = true;
+    }
+    wake_.notify_all();
+    for (auto& t : threads_) t.join();
+}
+
+void WorkStealingPool::run(size_t count, const Task& task) {
+    if (count == 0) return;
+    for (size_t i = 0; i < count; i++) {
+        Queue& q = *queues_[i % queues_.size()];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        q.tasks.push_back(i);
+    }
+    if (!threads_.empty()) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        task_ = &task;
+        busy_ = static_cast<unsigned>(threads_.size());
+        generation_++;
+    }
+    wake_.notify_all();
+
+    drain(0, task);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this] { return busy_ == 0; });
+    task_ = nullptr;
+}
+
+// Own queue from the back (the most recently dealt task), others' from the front.
+bool WorkStealingPool::take(unsigned worker, size_t& index) {
+    {
+        Queue& own = *queues_[worker];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            index = own.tasks.back();
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    for (size_t k = 1; k < queues_.size(); k++) {
+        Queue& victim = *queues_[(worker + k) % queues_.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            index = victim.tasks.front();
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+// Tasks are only queued at the start of a run, so once every queue is empty it stays so.
+void WorkStealingPool::drain(unsigned worker, const Task& task) {
+    size_t index;
+    while (take(worker, index)) task(index, worker);
+}
+
+void WorkStealingPool::workerLoop(unsigned worker) {
+    uint64_t seen = 0;
+    for (;;) {
+        const Task* task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [&] { return quit_ || generation_ != seen; });
+            if (quit_) return;
+            seen = generation_;
+            task = task_;
+        }
+        drain(worker, *task);
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (--busy_ == 0) done_.notify_one();
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of workers, each with its own task queue. run() deals task indices out
+// round-robin; a worker that drains its own queue steals from the front of the others', so
+// tasks of very uneven size (search subtrees) still keep every core busy. The calling
+// thread takes part as worker 0, so a one-thread pool starts no threads at all.
+class WorkStealingPool {
+public:
+    using Task = std::function<void(size_t index, unsigned worker)>;
+
+    // 0: one worker per core.
+    explicit WorkStealingPool(unsigned threads = 0);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    unsigned size() const { return static_cast<unsigned>(queues_.size()); }
+
+    // Calls task(i, worker) once for each i < count and returns when all calls are done.
+    // `worker` < size() names the calling worker, for per-worker scratch state. Not reentrant.
+    void run(size_t count, const Task& task);
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<size_t> tasks;
+    };
+
+    bool take(unsigned worker, size_t& index);
+    void drain(unsigned worker, const Task& task);
+    void workerLoop(unsigned worker);
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> threads_;
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    const Task* task_ = nullptr;
+    uint64_t generation_ = 0;
+    unsigned busy_ = 0;  // background workers still draining the current run
+    bool quit_ = false;
+};
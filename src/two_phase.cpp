@@ -0,0 +1,234 @@
+#include "two_phase.h"
+#include "coord.h"
+#include "move_automaton.h"
+
+#include <algorithm>
+
+namespace {
+
+constexpr uint8_t kUnvisited = 0xFF;
+constexpr int kMaxLength = 31;  // phase 1 needs at most 12 moves, phase 2 at most 18
+// Deep phase-2 searches are slow and rarely give the best total; a longer phase 1 with a
+// short phase 2 is found sooner.
+constexpr int kMaxPhase2 = 12;
+
+constexpr uint32_t buildG1Moves() {
+    uint32_t mask = 0;
+    for (int m = 0; m < kFaceMoves; m++) {
+        int face = m / 3;
+        if (face == FACE_U || face == FACE_D || m % 3 == 2) mask |= 1u << m;
+    }
+    return mask;
+}
+
+constexpr uint32_t kG1Moves = buildG1Moves();
+
+// Breadth-first distances from `goal` over `moves`; next(index, move) is the transition.
+template <typename Next>
+std::vector<uint8_t> buildPruning(size_t size, uint32_t goal, uint32_t moves, Next next) {
+    std::vector<uint8_t> table(size, kUnvisited);
+    std::vector<uint32_t> frontier = {goal};
+    std::vector<uint32_t> following;
+    table[goal] = 0;
+    for (uint8_t depth = 1; !frontier.empty(); depth++) {
+        following.clear();
+        for (uint32_t i : frontier) {
+            for (uint32_t left = moves; left; left &= left - 1) {
+                uint32_t j = next(i, __builtin_ctz(left));
+                if (table[j] != kUnvisited) continue;
+                table[j] = depth;
+                following.push_back(j);
+            }
+        }
+        frontier.swap(following);
+    }
+    return table;
+}
+
+size_t at(int coord, int move) {
+    return static_cast<size_t>(coord) * CoordTables::kMoves + static_cast<size_t>(move);
+}
+
+class Search {
+public:
+    Search(const CubieCube& start, std::atomic_bool* cancel, SolverProgress* progress, int target)
+        : coords_(CoordTables::get()),
+          prune_(TwoPhaseTables::get()),
+          start_(start),
+          cancel_(cancel),
+          progress_(progress),
+          target_(target),
+          startCorners_(start.cornerPerm()),
+          startSliceSorted_(start.sliceSorted()) {}
+
+    std::vector<Move> run() {
+        // Polling only every 4096 nodes would let a short search ignore an early cancel.
+        if (cancel_ && cancel_->load(std::memory_order_relaxed)) return {};
+        int twist = start_.twist();
+        int flip = start_.flip();
+        int slice = start_.slice();
+        int h = phase1Bound(twist, flip, slice);
+        for (int depth = h; depth < limit_ && !stop_; depth++) {
+            if (progress_) progress_->depth.store(depth, std::memory_order_relaxed);
+            phase1(twist, flip, slice, 0, depth, MoveAutomaton::kStart);
+        }
+        flushNodes();
+        if (cancelled_) return {};
+        return best_;
+    }
+
+private:
+    int phase1Bound(int twist, int flip, int slice) const {
+        int t = prune_.twistSlice[static_cast<size_t>(slice) * CoordTables::kTwist + twist];
+        int f = prune_.flipSlice[static_cast<size_t>(slice) * CoordTables::kFlip + flip];
+        return std::max(t, f);
+    }
+
+    int phase2Bound(int corners, int udEdges, int slice) const {
+        return std::max(prune_.cornerSlice[static_cast<size_t>(corners) * TwoPhaseTables::kSliceG1 + slice],
+                        prune_.udEdgesSlice[static_cast<size_t>(udEdges) * TwoPhaseTables::kSliceG1 + slice]);
+    }
+
+    void countNode() {
+        if (++nodes_ % 4096 != 0) return;
+        flushNodes();
+        if (cancel_ && cancel_->load(std::memory_order_relaxed)) {
+            cancelled_ = true;
+            stop_ = true;
+        }
+        if (!best_.empty() && nodes_ - firstSolutionNodes_ >= TwoPhaseSolver::kNodeBudget) stop_ = true;
+    }
+
+    void flushNodes() {
+        if (progress_) progress_->nodes.fetch_add(nodes_ - reported_, std::memory_order_relaxed);
+        reported_ = nodes_;
+    }
+
+    void phase1(int twist, int flip, int slice, int depth, int togo, int automaton) {
+        if (togo == 0) {
+            // Ending on a G1 move means a shorter phase-1 path already reached this state.
+            if (depth == 0 || !((kG1Moves >> static_cast<int>(path_[depth - 1])) & 1u)) {
+                startPhase2(depth, automaton);
+            }
+            return;
+        }
+        for (uint32_t moves = MoveAutomaton::allowed(automaton); moves && !stop_; moves &= moves - 1) {
+            int m = __builtin_ctz(moves);
+            int t = coords_.twistMove[at(twist, m)];
+            int f = coords_.flipMove[at(flip, m)];
+            int s = coords_.sliceMove[at(slice, m)];
+            if (phase1Bound(t, f, s) >= togo) continue;
+            countNode();
+            path_[depth] = static_cast<Move>(m);
+            phase1(t, f, s, depth + 1, togo - 1, MoveAutomaton::next(static_cast<Move>(m)));
+        }
+    }
+
+    void startPhase2(int depth, int automaton) {
+        // Most G1 arrivals cannot finish within the current limit; the corner and slice
+        // coordinates (a few table lookups along the path) usually show that already.
+        int corners = startCorners_;
+        int slice = startSliceSorted_;
+        for (int i = 0; i < depth; i++) {
+            corners = coords_.cornerPermMove[at(corners, static_cast<int>(path_[i]))];
+            slice = coords_.sliceSortedMove[at(slice, static_cast<int>(path_[i]))];
+        }
+        if (depth + prune_.cornerSlice[static_cast<size_t>(corners) * TwoPhaseTables::kSliceG1 + slice] >= limit_)
+            return;
+
+        // The U/D edge coordinate is undefined outside G1, so it is read off the cubies.
+        CubieCube c = start_;
+        for (int i = 0; i < depth; i++) c.applyMove(path_[i]);
+        int udEdges = c.udEdges();
+        int maxTogo = std::min(kMaxPhase2, limit_ - 1 - depth);
+        for (int togo = phase2Bound(corners, udEdges, slice); togo <= maxTogo; togo++) {
+            if (phase2(corners, udEdges, slice, depth, togo, automaton)) {
+                if (best_.empty()) firstSolutionNodes_ = nodes_;
+                best_.assign(path_, path_ + depth + togo);
+                limit_ = depth + togo;
+                if (limit_ <= target_) stop_ = true;
+                return;
+            }
+        }
+    }
+
+    bool phase2(int corners, int udEdges, int slice, int depth, int togo, int automaton) {
+        if (togo == 0) return true;  // bound 0: corners, U/D edges and slice edges all home
+        for (uint32_t moves = MoveAutomaton::allowed(automaton) & kG1Moves; moves; moves &= moves - 1) {
+            int m = __builtin_ctz(moves);
+            int c = coords_.cornerPermMove[at(corners, m)];
+            int u = coords_.udEdgesMove[at(udEdges, m)];
+            int s = coords_.sliceSortedMove[at(slice, m)];
+            if (phase2Bound(c, u, s) >= togo) continue;
+            countNode();
+            path_[depth] = static_cast<Move>(m);
+            if (phase2(c, u, s, depth + 1, togo - 1, MoveAutomaton::next(static_cast<Move>(m)))) return true;
+        }
+        return false;
+    }
+
+    const CoordTables& coords_;
+    const TwoPhaseTables& prune_;
+    CubieCube start_;
+    std::atomic_bool* cancel_;
+    SolverProgress* progress_;
+    int target_;
+    int startCorners_;
+    int startSliceSorted_;
+
+    Move path_[kMaxLength + 1] = {};
+    std::vector<Move> best_;
+    int limit_ = kMaxLength;  // a new solution must be shorter than this
+    uint64_t nodes_ = 0;
+    uint64_t firstSolutionNodes_ = 0;  // nodes_ when best_ was first set; the budget starts there
+    uint64_t reported_ = 0;
+    bool stop_ = false;
+    bool cancelled_ = false;
+};
+
+} // namespace
+
+TwoPhaseTables::TwoPhaseTables() {
+    const CoordTables& t = CoordTables::get();
+    const CubieCube solved;
+    constexpr uint32_t kAllMoves = MoveAutomaton::kAllMoves;
+
+    auto slice = static_cast<uint32_t>(solved.slice());
+    twistSlice = buildPruning(static_cast<size_t>(CoordTables::kSlice) * CoordTables::kTwist,
+                              slice * CoordTables::kTwist, kAllMoves, [&t](uint32_t i, int m) {
+                                  return t.sliceMove[at(i / CoordTables::kTwist, m)] * CoordTables::kTwist +
+                                         t.twistMove[at(i % CoordTables::kTwist, m)];
+                              });
+    flipSlice = buildPruning(static_cast<size_t>(CoordTables::kSlice) * CoordTables::kFlip,
+                             slice * CoordTables::kFlip, kAllMoves, [&t](uint32_t i, int m) {
+                                 return t.sliceMove[at(i / CoordTables::kFlip, m)] * CoordTables::kFlip +
+                                        t.flipMove[at(i % CoordTables::kFlip, m)];
+                             });
+
+    auto sliceSorted = static_cast<uint32_t>(solved.sliceSorted());
+    cornerSlice = buildPruning(static_cast<size_t>(CoordTables::kCornerPerm) * kSliceG1,
+                               static_cast<uint32_t>(solved.cornerPerm()) * kSliceG1 + sliceSorted, kG1Moves,
+                               [&t](uint32_t i, int m) {
+                                   return t.cornerPermMove[at(i / kSliceG1, m)] * kSliceG1 +
+                                          t.sliceSortedMove[at(i % kSliceG1, m)];
+                               });
+    udEdgesSlice = buildPruning(static_cast<size_t>(CoordTables::kUdEdges) * kSliceG1,
+                                static_cast<uint32_t>(solved.udEdges()) * kSliceG1 + sliceSorted, kG1Moves,
+                                [&t](uint32_t i, int m) {
+                                    return t.udEdgesMove[at(i / kSliceG1, m)] * kSliceG1 +
+                                           t.sliceSortedMove[at(i % kSliceG1, m)];
+                                });
+}
+
+const TwoPhaseTables& TwoPhaseTables::get() {
+    static const TwoPhaseTables tables;
+    return tables;
+}
+
+std::vector<Move> TwoPhaseSolver::solve(const CubieCube& start,
+                                        std::atomic_bool* cancel,
+                                        SolverProgress* progress,
+                                        int targetLength) {
+    if (start.isSolved()) return {};
+    return Search(start, cancel, progress, targetLength).run();
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include "cube.h"
+#include "solver.h"
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// Pruning tables for the two-phase search: each entry is the exact number of moves needed
+// to solve a pair of coordinates, a lower bound for the whole state.
+//
+// Phase 1 (any state -> G1, the group of <U, D, L2, R2, F2, B2>) uses twist x slice and
+// flip x slice; phase 2 (G1 -> solved) uses cornerPerm x sliceSorted and
+// udEdges x sliceSorted, with sliceSorted < 24 inside G1. About 4 MB in total.
+struct TwoPhaseTables {
+    static constexpr int kSliceG1 = 24;
+
+    std::vector<uint8_t> twistSlice;        // [slice * kTwist + twist]
+    std::vector<uint8_t> flipSlice;         // [slice * kFlip + flip]
+    std::vector<uint8_t> cornerSlice;       // [cornerPerm * kSliceG1 + sliceSorted]
+    std::vector<uint8_t> udEdgesSlice;      // [udEdges * kSliceG1 + sliceSorted]
+
+    // Built on first use (thread-safe) and shared read-only afterwards.
+    static const TwoPhaseTables& get();
+
+private:
+    TwoPhaseTables();
+};
+
+// Kociemba's two-phase algorithm: IDA* into G1, then IDA* within G1, trying longer phase-1
+// paths while they can still shorten the best total. Solutions are not optimal but come
+// back in milliseconds at 20-22 moves. Face moves only, canonical across the phase seam.
+class TwoPhaseSolver {
+public:
+    // Stop at the first solution this short or shorter.
+    static constexpr int kTargetLength = 21;
+    // Once a solution exists, give up improving it after this many search nodes.
+    static constexpr uint64_t kNodeBudget = 1'000'000;
+
+    // Empty when `start` is solved or the search was cancelled. `start` must be solvable.
+    static std::vector<Move> solve(const CubieCube& start,
+                                   std::atomic_bool* cancel = nullptr,
+                                   SolverProgress* progress = nullptr,
+                                   int targetLength = kTargetLength);
+};
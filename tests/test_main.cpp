@@ -1,11 +1,29 @@
+#include "basic_cube.h"
+#include "batch_file.h"
+#include "coord.h"
 #include "cube.h"
+#include "facelet_gather.h"
+#include "move_automaton.h"
+#include "notation.h"
+#include "optimal.h"
+#include "random_state.h"
+#include "sequence.h"
 #include "solver.h"
+#include "symmetry.h"
+#include "thread_pool.h"
+#include "two_phase.h"
 
+#include <algorithm>
 #include <array>
+#include <cstdio>
 #include <cstdint>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <random>
 #include <set>
 #include <string>
+#include <thread>
 #include <vector>
 
 struct TestCtx {
@@ -263,6 +281,892 @@ static void test_move_matches_physical_model(TestCtx& ctx) {
     }
 }
 
+static void test_move_tables_match_reference(TestCtx& ctx) {
+    for (int m = 0; m < 18; m++) {
+        Cube c;
+        c.reset();
+        c.applyMoveReference(static_cast<Move>(m));
+        EXPECT_TRUE(ctx, c.getState() == applyMovePhysical(Cube().getState(), static_cast<Move>(m)));
+    }
+
+    // Long pseudo-random sequence: table path and geometric path must stay in lockstep.
+    Cube table;
+    Cube reference;
+    std::mt19937 rng(12345);
+    std::uniform_int_distribution<int> dist(0, 17);
+    for (int i = 0; i < 500; i++) {
+        Move m = static_cast<Move>(dist(rng));
+        table.applyMove(m);
+        reference.applyMoveReference(m);
+        if (!(table.getState() == reference.getState())) {
+            std::cerr << "Table/reference diverged at step " << i << " (" << Cube::moveToString(m) << ")\n";
+            EXPECT_TRUE(ctx, false);
+            return;
+        }
+    }
+    EXPECT_TRUE(ctx, true);
+
+    // The tables and applyMoveReference share NxnGeometry, so check them against facts that
+    // do not: U and R written out by hand (faces U, D, L, R, F, B of 9 facelets, row-major as
+    // seen from outside; a clockwise face gathers new[r][c] = old[2-c][r]) ...
+    std::array<uint8_t, 54> u, r;
+    for (int i = 0; i < 54; i++) u[i] = r[i] = static_cast<uint8_t>(i);
+    for (int row = 0; row < 3; row++) {
+        for (int col = 0; col < 3; col++) {
+            u[row * 3 + col] = static_cast<uint8_t>((2 - col) * 3 + row);
+            r[27 + row * 3 + col] = static_cast<uint8_t>(27 + (2 - col) * 3 + row);
+        }
+    }
+    for (int j = 0; j < 3; j++) {
+        u[18 + j] = static_cast<uint8_t>(36 + j);  // L <- F
+        u[36 + j] = static_cast<uint8_t>(27 + j);  // F <- R
+        u[27 + j] = static_cast<uint8_t>(45 + j);  // R <- B
+        u[45 + j] = static_cast<uint8_t>(18 + j);  // B <- L
+        r[j * 3 + 2] = static_cast<uint8_t>(36 + j * 3 + 2);        // U <- F
+        r[36 + j * 3 + 2] = static_cast<uint8_t>(9 + j * 3 + 2);    // F <- D
+        r[9 + (2 - j) * 3 + 2] = static_cast<uint8_t>(45 + j * 3);  // D <- B, upside down
+        r[45 + (2 - j) * 3] = static_cast<uint8_t>(j * 3 + 2);      // B <- U, upside down
+    }
+    EXPECT_TRUE(ctx, Cube::movePermutation(Move::U) == u);
+    EXPECT_TRUE(ctx, Cube::movePermutation(Move::R) == r);
+
+    // ... and the known orders of a few sequences: R U 105, R U R' U' 6, R U2 D' B D' 1260.
+    const std::pair<std::vector<Move>, int> orders[] = {
+        {{Move::R, Move::U}, 105},
+        {{Move::R, Move::U, Move::Rp, Move::Up}, 6},
+        {{Move::R, Move::U2, Move::Dp, Move::B, Move::Dp}, 1260},
+    };
+    for (const auto& [sequence, order] : orders) {
+        Cube c;
+        int n = 0;
+        do {
+            c.applyMoves(sequence);
+            n++;
+        } while (!c.isSolved() && n <= order);
+        EXPECT_EQ(ctx, n, order);
+    }
+
+    for (int m = 0; m < 18; m++) {
+        const auto& perm = Cube::movePermutation(static_cast<Move>(m));
+        std::set<int> seen(perm.begin(), perm.end());
+        EXPECT_EQ(ctx, (int)seen.size(), 54);
+        // Centres never move under face turns.
+        for (int f = 0; f < 6; f++) EXPECT_EQ(ctx, (int)perm[f * 9 + 4], f * 9 + 4);
+    }
+}
+
+static void test_simd_kernel_matches_scalar(TestCtx& ctx) {
+    bool restore = FaceletGather::simdEnabled();
+
+    std::mt19937 rng(777);
+    std::uniform_int_distribution<int> dist(0, 17);
+    std::vector<Move> seq;
+    for (int i = 0; i < 300; i++) seq.push_back(static_cast<Move>(dist(rng)));
+
+    FaceletGather::setSimdEnabled(false);
+    Cube scalar;
+    std::vector<bool> scalarSolved;
+    for (auto m : seq) {
+        scalar.applyMove(m);
+        scalarSolved.push_back(scalar.isSolved());
+    }
+
+    FaceletGather::setSimdEnabled(FaceletGather::simdSupported());
+    Cube simd;
+    std::vector<bool> simdSolved;
+    for (auto m : seq) {
+        simd.applyMove(m);
+        simdSolved.push_back(simd.isSolved());
+    }
+
+    EXPECT_TRUE(ctx, scalar.getState() == simd.getState());
+    EXPECT_TRUE(ctx, scalarSolved == simdSolved);
+
+    for (bool enabled : {false, true}) {
+        FaceletGather::setSimdEnabled(enabled);
+        Cube a;
+        Cube b;
+        EXPECT_TRUE(ctx, a == b);
+        EXPECT_TRUE(ctx, a.isSolved());
+        b.applyMove(Move::R);
+        EXPECT_TRUE(ctx, a != b);
+        EXPECT_TRUE(ctx, !b.isSolved());
+        b.applyMove(Move::Rp);
+        EXPECT_TRUE(ctx, a == b);
+
+        // A difference in the final (overlapping) SIMD lane must still be detected.
+        auto s = a.getState();
+        std::swap(s[52], s[53 - 9]);
+        b.setState(s);
+        EXPECT_TRUE(ctx, a != b);
+        EXPECT_TRUE(ctx, !b.isSolved());
+    }
+
+    FaceletGather::setSimdEnabled(restore);
+}
+
+static void test_move_sequence_fusion(TestCtx& ctx) {
+    std::mt19937 rng(5150);
+    std::uniform_int_distribution<int> dist(0, 17);
+    std::vector<Move> moves;
+    for (int i = 0; i < 100; i++) moves.push_back(static_cast<Move>(dist(rng)));
+
+    Cube stepwise;
+    for (auto m : moves) stepwise.applyMove(m);
+
+    Cube batched;
+    batched.applyMoves(moves);
+    EXPECT_TRUE(ctx, batched == stepwise);
+
+    MoveSequence seq(moves);
+    Cube fused;
+    seq.applyTo(fused);
+    EXPECT_TRUE(ctx, fused == stepwise);
+    EXPECT_TRUE(ctx, fused.cubies() == stepwise.cubies());
+
+    // One fused permutation applied to many different starting states.
+    std::vector<Cube> starts(8);
+    for (size_t i = 0; i < starts.size(); i++) {
+        for (size_t j = 0; j <= i; j++) starts[i].applyMove(static_cast<Move>(dist(rng)));
+    }
+    std::vector<Cube> expected = starts;
+    for (auto& c : expected) c.applyMoves(moves);
+    seq.applyTo(starts);
+    for (size_t i = 0; i < starts.size(); i++) EXPECT_TRUE(ctx, starts[i] == expected[i]);
+
+    // Extending the sequence refreshes the fused permutation.
+    seq.push(Move::R);
+    Cube extended;
+    seq.applyTo(extended);
+    stepwise.applyMove(Move::R);
+    EXPECT_TRUE(ctx, extended == stepwise);
+
+    EXPECT_TRUE(ctx, MoveSequence().fused().index() == FaceletGather().index());
+}
+
+static void test_move_sequence_simplify(TestCtx& ctx) {
+    using V = std::vector<Move>;
+    EXPECT_TRUE(ctx, MoveSequence::simplified({Move::R, Move::Rp}).empty());
+    EXPECT_TRUE(ctx, MoveSequence::simplified({Move::U, Move::U2}) == V{Move::Up});
+    EXPECT_TRUE(ctx, MoveSequence::simplified({Move::D, Move::U}) == (V{Move::U, Move::D}));
+    // Cancellation across a commuting neighbour, then a cascade into the run before it.
+    EXPECT_TRUE(ctx, MoveSequence::simplified({Move::F, Move::U, Move::D, Move::Up, Move::Dp, Move::F}) ==
+                         V{Move::F2});
+    EXPECT_TRUE(ctx, MoveSequence::simplified({Move::R, Move::M, Move::Mp, Move::Rp}).empty());
+    EXPECT_TRUE(ctx, MoveSequence::simplified({Move::R, Move::COUNT, Move::L}) == (V{Move::L, Move::R}));
+
+    std::mt19937 rng(21);
+    std::uniform_int_distribution<int> dist(0, static_cast<int>(Move::COUNT) - 1);
+    std::uniform_int_distribution<int> few(0, 5);
+    for (int run = 0; run < 200; run++) {
+        V moves;
+        // Mostly one axis so that merges and cancellations actually happen.
+        for (int i = 0; i < 30; i++) {
+            moves.push_back(static_cast<Move>(run % 2 ? dist(rng) : few(rng) * 3 + few(rng) % 3));
+        }
+        V simple = MoveSequence::simplified(moves);
+        EXPECT_TRUE(ctx, simple.size() <= moves.size());
+        EXPECT_TRUE(ctx, MoveSequence::simplified(simple) == simple);
+
+        Cube a, b;
+        a.applyMoves(moves);
+        b.applyMoves(simple);
+        EXPECT_TRUE(ctx, a == b);
+    }
+
+    MoveSequence seq({Move::U, Move::U, Move::U});
+    seq.simplify();
+    EXPECT_TRUE(ctx, seq.moves() == V{Move::Up});
+    Cube viaFused;
+    seq.applyTo(viaFused);
+    Cube direct;
+    direct.applyMove(Move::Up);
+    EXPECT_TRUE(ctx, viaFused == direct);
+}
+
+static void test_move_automaton(TestCtx& ctx) {
+    // Canonical sequence counts per length: 18, 243, 3240 (then 43254, 577368, ...).
+    std::array<uint64_t, MoveAutomaton::kStates> counts{};
+    counts[MoveAutomaton::kStart] = 1;
+    const uint64_t expected[] = {18, 243, 3240, 43254, 577368};
+    for (uint64_t want : expected) {
+        std::array<uint64_t, MoveAutomaton::kStates> next{};
+        for (int state = 0; state < MoveAutomaton::kStates; state++) {
+            for (int m = 0; m < kFaceMoves; m++) {
+                Move move = static_cast<Move>(m);
+                if (MoveAutomaton::allows(state, move)) next[MoveAutomaton::next(move)] += counts[state];
+            }
+        }
+        counts = next;
+        uint64_t total = 0;
+        for (uint64_t c : counts) total += c;
+        EXPECT_EQ(ctx, total, want);
+    }
+
+    // Slice turn metric: every state within 3 moves of any of the 27 is still reachable in
+    // canonical order, from fewer sequences.
+    {
+        std::set<std::pair<uint64_t, uint64_t>> all, canonical;
+        std::vector<std::pair<CubieCube, int>> free = {{CubieCube(), 0}};
+        std::vector<std::pair<CubieCube, int>> ordered = {{CubieCube(), MoveAutomaton::kSliceStart}};
+        size_t freeCount = 0, orderedCount = 0;
+        for (int depth = 1; depth <= 3; depth++) {
+            std::vector<std::pair<CubieCube, int>> nextFree, nextOrdered;
+            for (const auto& node : free) {
+                for (int m = 0; m < MoveAutomaton::kSliceMoves; m++) {
+                    CubieCube c = node.first;
+                    c.applyMove(static_cast<Move>(m));
+                    PackedCube p = c.pack();
+                    all.insert({p.lo, p.hi});
+                    nextFree.push_back({c, 0});
+                }
+            }
+            for (const auto& node : ordered) {
+                for (uint32_t moves = MoveAutomaton::allowedSlice(node.second); moves; moves &= moves - 1) {
+                    Move m = static_cast<Move>(__builtin_ctz(moves));
+                    CubieCube c = node.first;
+                    c.applyMove(m);
+                    PackedCube p = c.pack();
+                    canonical.insert({p.lo, p.hi});
+                    nextOrdered.push_back({c, MoveAutomaton::nextSlice(m)});
+                }
+            }
+            freeCount = nextFree.size();
+            orderedCount = nextOrdered.size();
+            free = std::move(nextFree);
+            ordered = std::move(nextOrdered);
+        }
+        EXPECT_TRUE(ctx, all == canonical);
+        EXPECT_TRUE(ctx, orderedCount < freeCount);
+        // Restricted to face moves, the slice automaton is the face automaton.
+        bool same = true;
+        for (int state = 0; state < MoveAutomaton::kStates; state++) {
+            int sliceState = state == MoveAutomaton::kStart ? MoveAutomaton::kSliceStart : state;
+            same = same && (MoveAutomaton::allowedSlice(sliceState) & MoveAutomaton::kAllMoves) == MoveAutomaton::allowed(state);
+        }
+        EXPECT_TRUE(ctx, same);
+    }
+
+    // Up to depth 3 there are no redundant canonical sequences: the 3240 of length 3 reach
+    // 3240 distinct states, exactly the states at distance 3.
+    std::set<std::pair<uint64_t, uint64_t>> seen;
+    std::set<std::pair<uint64_t, uint64_t>> shorter;
+    std::vector<std::pair<CubieCube, int>> layer = {{CubieCube(), MoveAutomaton::kStart}};
+    for (int depth = 1; depth <= 3; depth++) {
+        std::vector<std::pair<CubieCube, int>> nextLayer;
+        for (const auto& node : layer) {
+            PackedCube p = node.first.pack();
+            shorter.insert({p.lo, p.hi});
+            for (int m = 0; m < kFaceMoves; m++) {
+                if (!MoveAutomaton::allows(node.second, static_cast<Move>(m))) continue;
+                CubieCube c = node.first;
+                c.applyMove(static_cast<Move>(m));
+                nextLayer.push_back({c, MoveAutomaton::next(static_cast<Move>(m))});
+            }
+        }
+        layer = std::move(nextLayer);
+    }
+    for (const auto& node : layer) {
+        PackedCube p = node.first.pack();
+        if (!shorter.count({p.lo, p.hi})) seen.insert({p.lo, p.hi});
+    }
+    EXPECT_EQ(ctx, (int)layer.size(), 3240);
+    EXPECT_EQ(ctx, (int)seen.size(), 3240);
+
+    EXPECT_TRUE(ctx, !MoveAutomaton::allows(MoveAutomaton::next(Move::D), Move::U2));
+    EXPECT_TRUE(ctx, MoveAutomaton::allows(MoveAutomaton::next(Move::U), Move::Dp));
+    EXPECT_TRUE(ctx, !MoveAutomaton::allows(MoveAutomaton::next(Move::R2), Move::R));
+}
+
+static void test_notation(TestCtx& ctx) {
+    const std::string solved = "UUUUUUUUURRRRRRRRRFFFFFFFFFDDDDDDDDDLLLLLLLLLBBBBBBBBB";
+    EXPECT_EQ(ctx, Notation::formatFacelets(Cube().getState()), solved);
+    std::array<Color, 54> f{};
+    EXPECT_TRUE(ctx, Notation::parseFacelets(solved, f));
+    EXPECT_TRUE(ctx, f == Cube().getState());
+
+    // Reference string for a single R turn in the common URFDLB convention.
+    Cube r;
+    r.applyMove(Move::R);
+    EXPECT_EQ(ctx, Notation::formatFacelets(r.getState()),
+              std::string("UUFUUFUUFRRRRRRRRRFFDFFDFFDDDBDDBDDBLLLLLLLLLUBBUBBUBB"));
+
+    std::mt19937 rng(16);
+    std::uniform_int_distribution<int> dist(0, static_cast<int>(Move::COUNT) - 1);
+    Cube c;
+    for (int i = 0; i < 200; i++) {
+        c.applyMove(static_cast<Move>(dist(rng)));
+        std::string text = Notation::formatFacelets(c.getState());
+        std::array<Color, 54> back{};
+        EXPECT_TRUE(ctx, Notation::parseFacelets(text, back));
+        Cube parsed;
+        parsed.setState(back);
+        // Letters are relative to the centres: the parsed cube is the same state, held the
+        // standard way up.
+        EXPECT_TRUE(ctx, parsed.cubies() == c.cubies());
+    }
+    EXPECT_TRUE(ctx, !Notation::parseFacelets(solved.substr(1), f));
+    EXPECT_TRUE(ctx, !Notation::parseFacelets("X" + solved.substr(1), f));
+
+    std::vector<Move> moves;
+    EXPECT_TRUE(ctx, Notation::parseMoves("R U R' U'", moves));
+    EXPECT_TRUE(ctx, moves == (std::vector<Move>{Move::R, Move::U, Move::Rp, Move::Up}));
+    EXPECT_EQ(ctx, Notation::formatMoves(moves), std::string("R U R' U'"));
+    moves.clear();
+    EXPECT_TRUE(ctx, Notation::parseMoves("  Rw2' r M'\tx2\n", moves));
+    EXPECT_TRUE(ctx, moves == (std::vector<Move>{Move::Rw2, Move::Rw, Move::Mp, Move::x2}));
+    EXPECT_TRUE(ctx, !Notation::parseMoves("R U3", moves));
+    EXPECT_EQ(ctx, (int)moves.size(), 4);
+    for (int m = 0; m < static_cast<int>(Move::COUNT); m++) {
+        Move parsed = Move::COUNT;
+        EXPECT_TRUE(ctx, Notation::parseMove(Cube::moveToString(static_cast<Move>(m)), parsed));
+        EXPECT_TRUE(ctx, parsed == static_cast<Move>(m));
+    }
+
+    std::string twisted = Notation::formatFacelets(r.getState());
+    // U9, R1 and F3 are the URF corner's stickers: cycling them twists it in place.
+    char u9 = twisted[8];
+    twisted[8] = twisted[9];
+    twisted[9] = twisted[20];
+    twisted[20] = u9;
+    std::string text = "# rig 3\n" + solved + "\r\n\n" + solved.substr(3) + "\n" + twisted + "\n" +
+                       Notation::formatFacelets(r.getState());
+    std::vector<std::array<Color, 54>> states;
+    std::vector<NotationError> errors;
+    EXPECT_EQ(ctx, Notation::parseFaceletLines(text, states, &errors), size_t(2));
+    EXPECT_EQ(ctx, (int)errors.size(), 2);
+    if (errors.size() == 2) {
+        EXPECT_EQ(ctx, errors[0].line, size_t(4));
+        EXPECT_EQ(ctx, errors[1].line, size_t(5));
+        EXPECT_EQ(ctx, errors[1].reason, std::string(Cube::solvabilityName(Solvability::CornerTwist)));
+    }
+    EXPECT_TRUE(ctx, states.size() == 2 && states[1] == r.getState());
+
+    const std::string path = "rubcs_notation_test.txt";
+    {
+        std::ofstream out(path, std::ios::binary);
+        for (int i = 0; i < 1000; i++) out << Notation::formatFacelets(r.getState()) << "\n";
+    }
+    states.clear();
+    errors.clear();
+    EXPECT_TRUE(ctx, Notation::readFaceletFile(path, states, &errors));
+    EXPECT_EQ(ctx, (int)states.size(), 1000);
+    EXPECT_TRUE(ctx, errors.empty());
+    std::remove(path.c_str());
+    EXPECT_TRUE(ctx, !Notation::readFaceletFile(path, states));
+}
+
+static void test_batch_file(TestCtx& ctx) {
+    const std::string path = "rubcs_batch_test.bin";
+    std::remove(path.c_str());
+    std::mt19937 rng(17);
+    std::uniform_int_distribution<int> dist(0, kFaceMoves - 1);
+    std::vector<Cube> cubes;
+    std::vector<std::vector<Move>> scrambles;
+    Cube c;
+    for (int i = 0; i < 300; i++) {
+        Move m = static_cast<Move>(dist(rng));
+        c.applyMove(m);
+        cubes.push_back(c);
+        scrambles.push_back(std::vector<Move>(1, m));
+    }
+
+    BatchWriter writer;
+    EXPECT_TRUE(ctx, writer.open(path, true));
+    for (int i = 0; i < 200; i++) EXPECT_TRUE(ctx, writer.append(cubes[i], scrambles[i]));
+    EXPECT_TRUE(ctx, !writer.append(cubes[0], std::vector<Move>(BatchFile::kMaxSolution + 1, Move::U)));
+    EXPECT_TRUE(ctx, writer.close());
+    // Reopening with the other layout is refused; the same layout appends.
+    EXPECT_TRUE(ctx, !writer.open(path, false));
+    EXPECT_TRUE(ctx, writer.open(path, true));
+    EXPECT_EQ(ctx, writer.count(), uint64_t(200));
+    for (int i = 200; i < 300; i++) EXPECT_TRUE(ctx, writer.append(cubes[i].packed(), scrambles[i]));
+    EXPECT_TRUE(ctx, writer.flush());
+
+    BatchReader reader;
+    EXPECT_TRUE(ctx, reader.open(path));
+    EXPECT_EQ(ctx, reader.size(), uint64_t(300));
+    EXPECT_TRUE(ctx, reader.hasSolutions());
+    bool same = reader.size() == 300;
+    std::vector<Move> stored;
+    for (uint64_t i = 0; same && i < reader.size(); i++) {
+        same = reader.state(i) == cubes[i].packed() && reader.solution(i, stored) && stored == scrambles[i] &&
+               CubieCube::unpack(reader.state(i)) == cubes[i].cubies();
+    }
+    EXPECT_TRUE(ctx, same);
+    EXPECT_TRUE(ctx, writer.close());
+    reader.close();
+
+    // Moves outside the enum are refused on write and on read.
+    EXPECT_TRUE(ctx, writer.open(path, true));
+    EXPECT_TRUE(ctx, !writer.append(cubes[0], std::vector<Move>{Move::U, static_cast<Move>(200)}));
+    EXPECT_TRUE(ctx, !writer.append(cubes[0], std::vector<Move>{Move::COUNT}));
+    EXPECT_EQ(ctx, writer.count(), uint64_t(300));
+    EXPECT_TRUE(ctx, writer.close());
+    {
+        std::fstream f(path, std::ios::in | std::ios::out | std::ios::binary);
+        f.seekp(static_cast<std::streamoff>(BatchFile::kHeaderSize + 4 * (BatchFile::kStateSize + BatchFile::kSolutionSlot) +
+                                            BatchFile::kStateSize + 1));
+        f.put(static_cast<char>(200));
+        f.seekp(static_cast<std::streamoff>(BatchFile::kHeaderSize + 5 * (BatchFile::kStateSize + BatchFile::kSolutionSlot) +
+                                            BatchFile::kStateSize));
+        f.put(static_cast<char>(BatchFile::kMaxSolution + 1));
+    }
+    EXPECT_TRUE(ctx, reader.open(path));
+    EXPECT_TRUE(ctx, reader.solution(3, stored) && stored == scrambles[3]);
+    EXPECT_TRUE(ctx, !reader.solution(4, stored));
+    EXPECT_TRUE(ctx, !reader.solution(5, stored));
+    reader.close();
+    {
+        std::fstream f(path, std::ios::in | std::ios::out | std::ios::binary);
+        f.seekp(static_cast<std::streamoff>(BatchFile::kHeaderSize + 4 * (BatchFile::kStateSize + BatchFile::kSolutionSlot) +
+                                            BatchFile::kStateSize + 1));
+        f.put(static_cast<char>(scrambles[4][0]));
+        f.seekp(static_cast<std::streamoff>(BatchFile::kHeaderSize + 5 * (BatchFile::kStateSize + BatchFile::kSolutionSlot) +
+                                            BatchFile::kStateSize));
+        f.put(1);
+    }
+
+    // A corrupt record still reads raw, but does not decode: edge id 15 at position 0.
+    {
+        std::fstream f(path, std::ios::in | std::ios::out | std::ios::binary);
+        PackedCube bad = cubes[7].packed();
+        bad.hi |= 15;
+        f.seekp(static_cast<std::streamoff>(BatchFile::kHeaderSize + 7 * (BatchFile::kStateSize + BatchFile::kSolutionSlot)));
+        f.write(reinterpret_cast<const char*>(&bad), sizeof(bad));
+    }
+    EXPECT_TRUE(ctx, reader.open(path));
+    CubieCube decoded;
+    EXPECT_TRUE(ctx, reader.state(6, decoded) && decoded == cubes[6].cubies());
+    EXPECT_TRUE(ctx, !reader.state(7, decoded));
+    EXPECT_TRUE(ctx, reader.state(8, decoded));
+    reader.close();
+    {
+        std::fstream f(path, std::ios::in | std::ios::out | std::ios::binary);
+        PackedCube good = cubes[7].packed();
+        f.seekp(static_cast<std::streamoff>(BatchFile::kHeaderSize + 7 * (BatchFile::kStateSize + BatchFile::kSolutionSlot)));
+        f.write(reinterpret_cast<const char*>(&good), sizeof(good));
+    }
+
+    // Records written after the last flush are not committed.
+    EXPECT_TRUE(ctx, writer.open(path, true));
+    EXPECT_TRUE(ctx, writer.append(cubes[0]));
+    EXPECT_TRUE(ctx, reader.open(path));
+    EXPECT_EQ(ctx, reader.size(), uint64_t(300));
+    EXPECT_TRUE(ctx, writer.close());
+    EXPECT_TRUE(ctx, reader.open(path));
+    EXPECT_EQ(ctx, reader.size(), uint64_t(301));
+    reader.close();
+
+    // States-only layout, and a file that is not a batch file.
+    EXPECT_TRUE(ctx, writer.open(path + "2", false));
+    EXPECT_TRUE(ctx, writer.append(cubes[5], scrambles[5]));
+    EXPECT_TRUE(ctx, writer.close());
+    EXPECT_TRUE(ctx, reader.open(path + "2"));
+    EXPECT_TRUE(ctx, reader.size() == 1 && !reader.hasSolutions() && reader.solution(0, stored) && stored.empty());
+    EXPECT_TRUE(ctx, reader.size() == 1 && reader.state(0) == cubes[5].packed());
+    reader.close();
+    {
+        std::ofstream out(path + "2", std::ios::binary);
+        out << std::string(64, 'x');
+    }
+    EXPECT_TRUE(ctx, !reader.open(path + "2"));
+    EXPECT_TRUE(ctx, !writer.open(path + "2", false));
+    // A header written on a host of the other byte order.
+    {
+        BatchHeader h{};
+        std::memcpy(h.magic, "RUBCSBAT", 8);
+        h.version = BatchFile::kVersion;
+        h.byteOrder = __builtin_bswap64(BatchFile::kByteOrderMark);
+        std::ofstream out(path + "2", std::ios::binary);
+        out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    }
+    EXPECT_TRUE(ctx, !reader.open(path + "2"));
+    EXPECT_TRUE(ctx, !writer.open(path + "2", false));
+    std::remove(path.c_str());
+    std::remove((path + "2").c_str());
+    EXPECT_TRUE(ctx, !reader.open(path));
+}
+
+static void test_random_state_generator(TestCtx& ctx) {
+    RandomStateGenerator a(42), b(42), other(43);
+    Cube c;
+    int legal = 0;
+    int same = 0;
+    int differs = 0;
+    constexpr int kSamples = 48000;
+    int cornerAt[8] = {};
+    int twistAt[3] = {};
+    int edgeAt[12] = {};
+    for (int i = 0; i < kSamples; i++) {
+        CubieCube s = a.next();
+        same += s == b.next();
+        differs += s != other.next();
+        cornerAt[s.cp[0]]++;
+        twistAt[s.co[7]]++;
+        edgeAt[s.ep[11]]++;
+        if (i < 2000) {
+            c.setCubies(s);
+            legal += c.checkSolvable() == Solvability::Solvable;
+        }
+    }
+    EXPECT_EQ(ctx, legal, 2000);
+    EXPECT_EQ(ctx, same, kSamples);
+    EXPECT_TRUE(ctx, differs > kSamples - 10);
+    // Marginals of the last slots, which the parity fixup and the twist sum decide, stay flat.
+    for (int n : cornerAt) EXPECT_TRUE(ctx, n > kSamples / 8 * 9 / 10 && n < kSamples / 8 * 11 / 10);
+    for (int n : twistAt) EXPECT_TRUE(ctx, n > kSamples / 3 * 9 / 10 && n < kSamples / 3 * 11 / 10);
+    for (int n : edgeAt) EXPECT_TRUE(ctx, n > kSamples / 12 * 9 / 10 && n < kSamples / 12 * 11 / 10);
+
+    Rng rng(7);
+    int hits[5] = {};
+    for (int i = 0; i < 50000; i++) hits[rng.below(5)]++;
+    for (int n : hits) EXPECT_TRUE(ctx, n > 9000 && n < 11000);
+}
+
+static void test_seeded_scrambles(TestCtx& ctx) {
+    Cube a, b, c;
+    a.scramble(25, 99);
+    b.scramble(25, 99);
+    c.scramble(25, 100);
+    EXPECT_TRUE(ctx, a == b);
+    EXPECT_TRUE(ctx, a != c);
+
+    ScrambleBatch one = Scrambler::batch(5, 10000, 20, 1);
+    ScrambleBatch many = Scrambler::batch(5, 10000, 20, 4);
+    EXPECT_EQ(ctx, one.size(), size_t(10000));
+    EXPECT_TRUE(ctx, one.moves == many.moves && one.states == many.states);
+
+    bool valid = true;
+    for (size_t i = 0; i < one.size(); i++) {
+        std::vector<Move> s = one.scramble(i);
+        if (i % 1000 == 0) {
+            EXPECT_TRUE(ctx, s == Scrambler::generate(5, i, 20));
+            EXPECT_TRUE(ctx, CubieCube::fromMoves(s).pack() == one.states[i]);
+        }
+        for (size_t k = 0; k < s.size(); k++) {
+            int face = static_cast<int>(s[k]) / 3;
+            valid = valid && isFaceMove(s[k]);
+            if (k >= 1) valid = valid && face != static_cast<int>(s[k - 1]) / 3;
+            // No X Y X with X, Y opposite faces.
+            if (k >= 2) valid = valid && !(face == static_cast<int>(s[k - 2]) / 3 &&
+                                           face / 2 == static_cast<int>(s[k - 1]) / 6);
+        }
+    }
+    EXPECT_TRUE(ctx, valid);
+    // Every face move shows up, and at a plausible rate.
+    int seen[kFaceMoves] = {};
+    for (Move m : one.moves) seen[static_cast<int>(m)]++;
+    for (int n : seen) EXPECT_TRUE(ctx, n > 200000 / kFaceMoves / 2);
+    EXPECT_TRUE(ctx, Scrambler::batch(5, 0, 20).size() == 0);
+}
+
+static int countMisplacedFromScratch(const Cube& c) {
+    int n = 0;
+    for (int i = 0; i < 54; i++) {
+        if (c.getState()[i] != c.getState()[(i / 9) * 9 + 4]) n++;
+    }
+    return n;
+}
+
+static void test_incremental_misplaced_counter(TestCtx& ctx) {
+    bool restore = FaceletGather::simdEnabled();
+    for (bool simd : {false, true}) {
+        FaceletGather::setSimdEnabled(simd);
+
+        Cube c;
+        EXPECT_EQ(ctx, c.misplacedCount(), 0);
+        EXPECT_TRUE(ctx, c.isSolved());
+        c.applyMove(Move::R);
+        // R relocates 20 stickers, but the 8 on the R face still match their centre.
+        EXPECT_EQ(ctx, c.misplacedCount(), 12);
+
+        std::mt19937 rng(simd ? 2 : 1);
+        std::uniform_int_distribution<int> dist(0, 17);
+        for (int i = 0; i < 500; i++) {
+            c.applyMove(static_cast<Move>(dist(rng)));
+            if (c.misplacedCount() != countMisplacedFromScratch(c)) {
+                std::cerr << "misplaced counter diverged at step " << i << " (simd=" << simd << ")\n";
+                EXPECT_TRUE(ctx, false);
+                break;
+            }
+            uint64_t mask = 0;
+            for (int j = 0; j < 54; j++) {
+                if (c.getState()[j] != c.getState()[(j / 9) * 9 + 4]) mask |= uint64_t(1) << j;
+            }
+            EXPECT_EQ(ctx, c.misplacedMask(), mask);
+        }
+
+        // Undo everything in one batch: counter is refreshed by applyMoves too.
+        Cube back;
+        back.applyMoves({Move::U, Move::F2, Move::Lp});
+        EXPECT_EQ(ctx, back.misplacedCount(), countMisplacedFromScratch(back));
+        back.applyMoves({Move::L, Move::F2, Move::Up});
+        EXPECT_TRUE(ctx, back.isSolved());
+
+        Cube custom;
+        auto s = custom.getState();
+        std::swap(s[0], s[9]);
+        custom.setState(s);
+        EXPECT_EQ(ctx, custom.misplacedCount(), 2);
+        EXPECT_TRUE(ctx, !custom.isSolved());
+    }
+    FaceletGather::setSimdEnabled(restore);
+}
+
+static void test_incremental_hash(TestCtx& ctx) {
+    Cube solved;
+    EXPECT_EQ(ctx, solved.hash(), Cube::hashFromScratch(solved.getState()));
+
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<int> dist(0, 17);
+    for (int run = 0; run < 20; run++) {
+        Cube c;
+        std::vector<Move> moves;
+        for (int i = 0; i < 100; i++) {
+            Move m = static_cast<Move>(dist(rng));
+            moves.push_back(m);
+            c.applyMove(m);
+            if (c.hash() != Cube::hashFromScratch(c.getState())) {
+                std::cerr << "hash diverged at run " << run << " step " << i << "\n";
+                EXPECT_TRUE(ctx, false);
+                break;
+            }
+        }
+        // Every path to the same state must land on the same hash.
+        Cube batched;
+        batched.applyMoves(moves);
+        EXPECT_EQ(ctx, batched.hash(), c.hash());
+        for (auto it = moves.rbegin(); it != moves.rend(); ++it) c.applyMove(Cube::inverseMove(*it));
+        EXPECT_EQ(ctx, c.hash(), solved.hash());
+    }
+
+    Cube r;
+    r.applyMove(Move::R);
+    EXPECT_TRUE(ctx, r.hash() != solved.hash());
+    Cube viaState;
+    viaState.setState(r.getState());
+    EXPECT_EQ(ctx, viaState.hash(), r.hash());
+}
+
+static void test_slice_wide_rotation_moves(TestCtx& ctx) {
+    auto same = [](std::vector<Move> a, std::vector<Move> b) {
+        Cube x, y;
+        x.applyMoves(a);
+        y.applyMoves(b);
+        return x.getState() == y.getState();
+    };
+    EXPECT_TRUE(ctx, same({Move::M}, {Move::R, Move::Lp, Move::xp}));
+    EXPECT_TRUE(ctx, same({Move::E}, {Move::U, Move::Dp, Move::yp}));
+    EXPECT_TRUE(ctx, same({Move::S}, {Move::Fp, Move::B, Move::z}));
+    EXPECT_TRUE(ctx, same({Move::Rw}, {Move::L, Move::x}));
+    EXPECT_TRUE(ctx, same({Move::Lw}, {Move::R, Move::xp}));
+    EXPECT_TRUE(ctx, same({Move::Uw}, {Move::D, Move::y}));
+    EXPECT_TRUE(ctx, same({Move::Dw}, {Move::U, Move::yp}));
+    EXPECT_TRUE(ctx, same({Move::Fw}, {Move::B, Move::z}));
+    EXPECT_TRUE(ctx, same({Move::Bw}, {Move::F, Move::zp}));
+    EXPECT_TRUE(ctx, same({Move::x2}, {Move::x, Move::x}));
+    EXPECT_TRUE(ctx, same({Move::M2, Move::E2, Move::S2}, {Move::S2, Move::E2, Move::M2}));
+
+    for (int m = kFaceMoves; m < static_cast<int>(Move::COUNT); m++) {
+        Move move = static_cast<Move>(m);
+        Cube c;
+        c.applyMove(move);
+        EXPECT_EQ(ctx, c.checkSolvable(), Solvability::Solvable);
+        c.applyMove(Cube::inverseMove(move));
+        EXPECT_TRUE(ctx, c == Cube());
+    }
+    EXPECT_EQ(ctx, Cube::moveToString(Move::Mp), std::string("M'"));
+    EXPECT_EQ(ctx, Cube::moveToString(Move::Rw2), std::string("r2"));
+    EXPECT_EQ(ctx, Cube::moveToString(Move::yp), std::string("y'"));
+
+    // A rotated cube is still solved, and its cubie form is read relative to the centres.
+    Cube rotated;
+    rotated.applyMove(Move::x);
+    EXPECT_TRUE(ctx, rotated.isSolved());
+    EXPECT_TRUE(ctx, rotated.cubies().isSolved());
+    EXPECT_TRUE(ctx, rotated != Cube());
+
+    // The cubie form follows the centres: U x reads as B, since the turned layer is now at
+    // the back, while x U is just U.
+    Cube ux;
+    ux.applyMoves({Move::U, Move::x});
+    EXPECT_TRUE(ctx, ux.cubies() == CubieCube::fromMoves({Move::B}));
+    Cube xu;
+    xu.applyMoves({Move::x, Move::U});
+    EXPECT_TRUE(ctx, xu.cubies() == CubieCube::fromMoves({Move::U}));
+
+    // Random mixed sequences: derived state must track the facelets.
+    std::mt19937 rng(13);
+    std::uniform_int_distribution<int> dist(0, static_cast<int>(Move::COUNT) - 1);
+    Cube c;
+    CubieCube cc;
+    std::vector<Move> moves;
+    for (int i = 0; i < 300; i++) {
+        moves.push_back(static_cast<Move>(dist(rng)));
+        c.applyMove(moves.back());
+        cc.applyMove(moves.back());
+        EXPECT_TRUE(ctx, c.cubies() == cc);
+        EXPECT_EQ(ctx, c.checkSolvable(), Solvability::Solvable);
+        EXPECT_EQ(ctx, c.misplacedCount(), countMisplacedFromScratch(c));
+        EXPECT_EQ(ctx, c.hash(), Cube::hashFromScratch(c.getState()));
+    }
+    for (auto it = moves.rbegin(); it != moves.rend(); ++it) c.applyMove(Cube::inverseMove(*it));
+    EXPECT_TRUE(ctx, c == Cube());
+
+    // Slice moves shorten solutions: M' is a single move, and the optimal search finds R' L.
+    Cube sliced;
+    sliced.applyMove(Move::Mp);
+    auto solution = Solver(SolverMethod::Bidirectional).solve(sliced);
+    EXPECT_EQ(ctx, (int)solution.size(), 2);
+    sliced.applyMoves(solution);
+    EXPECT_TRUE(ctx, sliced.isSolved());
+
+    // In the slice turn metric it is undone by M itself, and slice-heavy states come back
+    // shorter than in face turns.
+    Solver sliceSolver(SolverMethod::BidirectionalSlice);
+    Cube mp;
+    mp.applyMove(Move::Mp);
+    EXPECT_TRUE(ctx, sliceSolver.solve(mp) == std::vector<Move>{Move::M});
+    const std::vector<std::vector<Move>> sliceScrambles = {
+        {Move::M, Move::U2, Move::Mp, Move::U2},           // 4 slice turns, 6 face turns
+        {Move::E, Move::R, Move::S, Move::Fp, Move::M2},
+        {Move::Sp, Move::U, Move::E2, Move::L, Move::Mp, Move::B2},
+    };
+    for (const auto& scramble : sliceScrambles) {
+        Cube cube;
+        cube.applyMoves(scramble);
+        auto stm = sliceSolver.solve(cube);
+        auto ftm = Solver(SolverMethod::Bidirectional).solve(cube);
+        EXPECT_TRUE(ctx, !stm.empty() && stm.size() <= scramble.size() && stm.size() < ftm.size());
+        cube.applyMoves(stm);
+        EXPECT_TRUE(ctx, cube.isSolved());
+        EXPECT_TRUE(ctx, MoveSequence::simplified(stm) == stm);
+    }
+}
+
+template <int N>
+static void checkNxnCube(TestCtx& ctx) {
+    using C = BasicCube<N>;
+    const auto& tables = kNxnMoveTables<N>;
+    for (int m = 0; m < C::kMoves; m++) {
+        std::set<int> seen(tables[m].begin(), tables[m].end());
+        EXPECT_EQ(ctx, (int)seen.size(), C::kFacelets);
+
+        // Outer turns relocate the face (minus a fixed centre on odd N) and a ring of 4N;
+        // inner slices only the ring.
+        int moved = 0;
+        for (int i = 0; i < C::kFacelets; i++) moved += tables[m][i] != i;
+        int depth = m / 18;
+        int expected = 4 * N + (depth == 0 || depth == N - 1 ? N * N - N % 2 : 0);
+        EXPECT_EQ(ctx, moved, expected);
+
+        C c;
+        for (int i = 0; i < 4; i++) c.applyMove(m);
+        EXPECT_TRUE(ctx, c.isSolved());
+        c.applyMove(m);
+        EXPECT_TRUE(ctx, !c.isSolved());
+        c.applyMove(C::inverseMove(m));
+        EXPECT_TRUE(ctx, c.isSolved());
+    }
+
+    // Depth d from a face is depth N-1-d from the opposite face, turning the other way.
+    for (int d = 0; d < N; d++) {
+        C a, b;
+        a.applyMove(FACE_R, d, 0);
+        b.applyMove(FACE_L, N - 1 - d, 1);
+        EXPECT_TRUE(ctx, a == b);
+    }
+
+    std::mt19937 rng(N);
+    std::uniform_int_distribution<int> dist(0, C::kMoves - 1);
+    C c;
+    std::vector<int> moves;
+    for (int i = 0; i < 200; i++) {
+        moves.push_back(dist(rng));
+        c.applyMove(moves.back());
+    }
+    EXPECT_TRUE(ctx, !c.isSolved());
+    for (auto it = moves.rbegin(); it != moves.rend(); ++it) c.applyMove(C::inverseMove(*it));
+    EXPECT_TRUE(ctx, c.isSolved());
+}
+
+// Named moves on N layers: M turns every inner layer like L, wide moves two layers, x all.
+template <int N>
+static void checkNxnNamedMoves(TestCtx& ctx) {
+    using C = BasicCube<N>;
+    C m, layers;
+    m.applyMove(Move::M);
+    for (int d = 1; d < N - 1; d++) layers.applyMove(FACE_L, d, 0);
+    EXPECT_TRUE(ctx, m == layers);
+    EXPECT_TRUE(ctx, m != C() || N == 2);
+    C innerU;
+    innerU.applyMove(FACE_U, 1, 0);
+    EXPECT_TRUE(ctx, m != innerU);
+
+    int moved = 0;
+    for (int i = 0; i < C::kFacelets; i++) moved += kNxnNamedMoveTables<N>[static_cast<int>(Move::M)][i] != i;
+    EXPECT_EQ(ctx, moved, 4 * N * (N - 2));
+
+    C x, parts;
+    x.applyMove(Move::x);
+    parts.applyMove(Move::R);
+    parts.applyMove(Move::Mp);
+    parts.applyMove(Move::Lp);
+    EXPECT_TRUE(ctx, x == parts);
+    // x turns like R: the front comes up, and every face stays a single colour.
+    bool up = true;
+    for (int i = 0; i < N * N; i++) up = up && x.getFacelet(FACE_U, i / N, i % N) == kFaceColor[FACE_F];
+    EXPECT_TRUE(ctx, up && x.isSolved() && x != C());
+    C full = x;
+    for (int i = 0; i < 3; i++) full.applyMove(Move::x);
+    EXPECT_TRUE(ctx, full == C());
+
+    C wide, two;
+    wide.applyMove(Move::Rw);
+    two.applyMove(FACE_R, 0, 0);
+    two.applyMove(FACE_R, 1, 0);
+    EXPECT_TRUE(ctx, wide == two);
+}
+
+static void test_nxn_cubes(TestCtx& ctx) {
+    // U, the middle layer and D' together turn the whole cube: only the U/D centres stay.
+    int moved = 0;
+    for (int i = 0; i < 54; i++) {
+        int j = kNxnMoveTables<3>[0][i];
+        j = kNxnMoveTables<3>[18][j];
+        j = kNxnMoveTables<3>[static_cast<int>(Move::Dp)][j];
+        moved += j != i;
+    }
+    EXPECT_EQ(ctx, moved, 54 - 2);
+
+    // The specialised Cube runs the same generic checks through its own move paths.
+    checkNxnCube<2>(ctx);
+    checkNxnCube<3>(ctx);
+    checkNxnCube<4>(ctx);
+    checkNxnCube<5>(ctx);
+    Cube slice, named;
+    slice.applyMove(Cube::moveIndex(FACE_L, 1, 0));
+    named.applyMove(Move::M);
+    EXPECT_TRUE(ctx, slice == named);
+    EXPECT_EQ(ctx, Cube::moveToString(Cube::moveIndex(FACE_U, 2, 2)), std::string("3U2"));
+
+    checkNxnNamedMoves<3>(ctx);
+    checkNxnNamedMoves<4>(ctx);
+    checkNxnNamedMoves<5>(ctx);
+    BasicCube<2> tiny;
+    tiny.applyMove(Move::M);
+    EXPECT_TRUE(ctx, tiny.isSolved());  // a 2x2 has no inner layer
+    tiny.applyMove(Move::x);
+    EXPECT_TRUE(ctx, tiny.getFacelet(FACE_U, 0, 0) == kFaceColor[FACE_F]);
+
+    BasicCube<4> big;
+    big.applyMove(Move::R);
+    EXPECT_EQ(ctx, BasicCube<4>::moveToString(BasicCube<4>::moveIndex(FACE_R, 1, 1)), std::string("2R'"));
+    EXPECT_TRUE(ctx, big.getFacelet(FACE_U, 0, 3) != Color::White);
+    EXPECT_TRUE(ctx, big.getFacelet(FACE_U, 0, 2) == Color::White);
+}
+
 static void test_inverse_and_identity(TestCtx& ctx) {
     // Inverse correctness
     for (int m = 0; m < 18; m++) {
@@ -369,6 +1273,256 @@ static void test_corner_edge_validity_invariants(TestCtx& ctx) {
     EXPECT_EQ(ctx, eoSum, 0);
 }
 
+static void test_cubie_form_matches_facelets(TestCtx& ctx) {
+    EXPECT_TRUE(ctx, Cube().cubies().isSolved());
+    EXPECT_TRUE(ctx, CubieCube().toFacelets() == Cube().getState());
+
+    std::mt19937 rng(99);
+    std::uniform_int_distribution<int> dist(0, 17);
+    Cube facelets;
+    CubieCube cubies;
+    for (int i = 0; i < 200; i++) {
+        Move m = static_cast<Move>(dist(rng));
+        facelets.applyMove(m);
+        cubies.applyMove(m);
+
+        // Moves applied on the 40-byte form agree with the facelet kernel.
+        EXPECT_TRUE(ctx, cubies.toFacelets() == facelets.getState());
+        // The cache is refreshed after each facelet move.
+        EXPECT_TRUE(ctx, facelets.cubies() == cubies);
+    }
+
+    Cube fromCubies;
+    fromCubies.setCubies(cubies);
+    EXPECT_TRUE(ctx, fromCubies == facelets);
+    for (int i = 0; i < 8; i++) {
+        EXPECT_EQ(ctx, fromCubies.getCornerPermutation(i), (int)cubies.cp[i]);
+        EXPECT_EQ(ctx, fromCubies.getCornerOrientation(i), (int)cubies.co[i]);
+    }
+    for (int i = 0; i < 12; i++) {
+        EXPECT_EQ(ctx, fromCubies.getEdgePermutation(i), (int)cubies.ep[i]);
+        EXPECT_EQ(ctx, fromCubies.getEdgeOrientation(i), (int)cubies.eo[i]);
+    }
+
+    // Unidentifiable cubies are reported rather than guessed.
+    auto s = Cube().getState();
+    s[FACE_U * 9 + 8] = Color::Green;  // green+blue+red is not a corner
+    CubieCube broken;
+    EXPECT_TRUE(ctx, !CubieCube::fromFacelets(s, broken));
+    EXPECT_EQ(ctx, broken.cp[0], CubieCube::kUnknown);
+}
+
+static void test_coordinates_roundtrip_and_tables(TestCtx& ctx) {
+    CubieCube solved;
+    EXPECT_EQ(ctx, solved.twist(), 0);
+    EXPECT_EQ(ctx, solved.flip(), 0);
+    EXPECT_EQ(ctx, solved.slice(), 0);
+    EXPECT_EQ(ctx, solved.sliceSorted(), 0);
+    EXPECT_EQ(ctx, solved.cornerPerm(), 0);
+    EXPECT_EQ(ctx, solved.edgePerm(), 0u);
+    EXPECT_EQ(ctx, solved.udEdges(), 0);
+
+    for (int v : {0, 1, 1000, 2186}) {
+        CubieCube c;
+        c.setTwist(v);
+        EXPECT_EQ(ctx, c.twist(), v);
+    }
+    for (int v : {0, 1, 777, 2047}) {
+        CubieCube c;
+        c.setFlip(v);
+        EXPECT_EQ(ctx, c.flip(), v);
+    }
+    for (int v = 0; v < CoordTables::kSliceSorted; v += 37) {
+        CubieCube c;
+        c.setSliceSorted(v);
+        EXPECT_EQ(ctx, c.sliceSorted(), v);
+        EXPECT_EQ(ctx, c.slice(), v / 24);
+    }
+    for (int v : {0, 1, 12345, 40319}) {
+        CubieCube c;
+        c.setCornerPerm(v);
+        EXPECT_EQ(ctx, c.cornerPerm(), v);
+        c.setUdEdges(v);
+        EXPECT_EQ(ctx, c.udEdges(), v);
+    }
+    for (uint32_t v : {0u, 1u, 123456789u, 479001599u}) {
+        CubieCube c;
+        c.setEdgePerm(v);
+        EXPECT_EQ(ctx, c.edgePerm(), v);
+    }
+
+    // Transition tables agree with moving the full cubie state.
+    const CoordTables& t = CoordTables::get();
+    std::mt19937 rng(4242);
+    std::uniform_int_distribution<int> dist(0, 17);
+    CubieCube c;
+    for (int i = 0; i < 300; i++) {
+        Move m = static_cast<Move>(dist(rng));
+        CubieCube next = c;
+        next.applyMove(m);
+        int mi = static_cast<int>(m);
+        EXPECT_EQ(ctx, (int)t.twistMove[c.twist() * CoordTables::kMoves + mi], next.twist());
+        EXPECT_EQ(ctx, (int)t.flipMove[c.flip() * CoordTables::kMoves + mi], next.flip());
+        EXPECT_EQ(ctx, (int)t.sliceMove[c.slice() * CoordTables::kMoves + mi], next.slice());
+        EXPECT_EQ(ctx, (int)t.sliceSortedMove[c.sliceSorted() * CoordTables::kMoves + mi], next.sliceSorted());
+        EXPECT_EQ(ctx, (int)t.cornerPermMove[c.cornerPerm() * CoordTables::kMoves + mi], next.cornerPerm());
+        c = next;
+    }
+
+    // U/D edge permutation stays defined under G1 moves.
+    CubieCube g1;
+    for (int i = 0; i < 100; i++) {
+        Move m = static_cast<Move>(dist(rng));
+        if (!CoordTables::isG1Move(m)) continue;
+        CubieCube next = g1;
+        next.applyMove(m);
+        EXPECT_EQ(ctx, (int)t.udEdgesMove[g1.udEdges() * CoordTables::kMoves + static_cast<int>(m)], next.udEdges());
+        EXPECT_TRUE(ctx, next.sliceSorted() < 24);
+        g1 = next;
+    }
+
+    Cube cube;
+    cube.applyMove(Move::R);
+    EXPECT_EQ(ctx, cube.twist(), cube.cubies().twist());
+    EXPECT_TRUE(ctx, cube.twist() != 0);
+    EXPECT_TRUE(ctx, cube.cornerPermutationRank() != 0);
+}
+
+static void test_packed_state(TestCtx& ctx) {
+    EXPECT_TRUE(ctx, CubieCube::unpack(CubieCube().pack()) == CubieCube());
+
+    std::mt19937 rng(2024);
+    std::uniform_int_distribution<int> dist(0, 17);
+    CubieCube c;
+    std::set<uint64_t> hashes;
+    std::set<std::pair<uint64_t, uint64_t>> states;
+    for (int i = 0; i < 2000; i++) {
+        c.applyMove(static_cast<Move>(dist(rng)));
+        PackedCube p = c.pack();
+        EXPECT_TRUE(ctx, CubieCube::unpack(p) == c);
+        states.insert({p.lo, p.hi});
+        hashes.insert(p.hash());
+    }
+    // Distinct states should essentially never share a 64-bit hash.
+    EXPECT_EQ(ctx, hashes.size(), states.size());
+
+    // unpack takes any bits; isValid catches what does not describe cubies.
+    EXPECT_TRUE(ctx, c.isValid());
+    CubieCube bad = c;
+    bad.ep[3] = 12;
+    EXPECT_TRUE(ctx, !bad.isValid());
+    bad = c;
+    bad.cp[0] = bad.cp[1];
+    EXPECT_TRUE(ctx, !bad.isValid());
+    bad = c;
+    bad.co[5] = 3;
+    EXPECT_TRUE(ctx, !bad.isValid());
+    PackedCube noise;
+    noise.lo = ~0ull;
+    noise.hi = ~0ull;
+    EXPECT_TRUE(ctx, !CubieCube::unpack(noise).isValid());
+
+    Cube a;
+    Cube b;
+    EXPECT_TRUE(ctx, a.packed() == b.packed());
+    b.applyMove(Move::F);
+    EXPECT_TRUE(ctx, a.packed() != b.packed());
+    EXPECT_TRUE(ctx, std::hash<PackedCube>()(b.packed()) == PackedCubeHash()(b.packed()));
+}
+
+static void test_cubie_group_algebra(TestCtx& ctx) {
+    std::mt19937 rng(31337);
+    std::uniform_int_distribution<int> dist(0, 17);
+    auto randomMoves = [&](int n) {
+        std::vector<Move> out;
+        for (int i = 0; i < n; i++) out.push_back(static_cast<Move>(dist(rng)));
+        return out;
+    };
+
+    for (int round = 0; round < 20; round++) {
+        auto ma = randomMoves(15);
+        auto mb = randomMoves(15);
+        CubieCube a = CubieCube::fromMoves(ma);
+        CubieCube b = CubieCube::fromMoves(mb);
+
+        std::vector<Move> both = ma;
+        both.insert(both.end(), mb.begin(), mb.end());
+        EXPECT_TRUE(ctx, a * b == CubieCube::fromMoves(both));
+
+        EXPECT_TRUE(ctx, (a * a.inverse()).isSolved());
+        EXPECT_TRUE(ctx, (a.inverse() * a).isSolved());
+        EXPECT_TRUE(ctx, a.inverse().inverse() == a);
+
+        std::vector<Move> undo;
+        for (auto it = ma.rbegin(); it != ma.rend(); ++it) undo.push_back(Cube::inverseMove(*it));
+        EXPECT_TRUE(ctx, a.inverse() == CubieCube::fromMoves(undo));
+
+        // Verification without replay: a followed by its undo sequence is solved.
+        EXPECT_TRUE(ctx, (a * CubieCube::fromMoves(undo)).isSolved());
+
+        EXPECT_TRUE(ctx, a.conjugate(b) == b.inverse() * a * b);
+        EXPECT_TRUE(ctx, a.conjugate(b).conjugate(b.inverse()) == a);
+        EXPECT_TRUE(ctx, (a * b).inverse() == b.inverse() * a.inverse());
+    }
+
+    Cube x;
+    x.applyMoves({Move::R, Move::U, Move::Fp});
+    EXPECT_TRUE(ctx, (x * x.inverse()).isSolved());
+    Cube y;
+    y.applyMoves({Move::F, Move::Up, Move::Rp});
+    EXPECT_TRUE(ctx, x.inverse() == y);
+}
+
+static void test_symmetry_reduction(TestCtx& ctx) {
+    // Group structure: identity first, inverses consistent, all 48 distinct.
+    EXPECT_TRUE(ctx, Symmetry::cube(0).isSolved());
+    std::set<std::pair<uint64_t, uint64_t>> distinct;
+    for (int s = 0; s < Symmetry::kCount; s++) {
+        EXPECT_TRUE(ctx, (Symmetry::cube(s) * Symmetry::cube(Symmetry::inverse(s))).isSolved());
+        PackedCube p = Symmetry::cube(s).pack();
+        distinct.insert({p.lo, p.hi});
+    }
+    EXPECT_EQ(ctx, (int)distinct.size(), Symmetry::kCount);
+
+    std::mt19937 rng(8);
+    std::uniform_int_distribution<int> dist(0, 17);
+    std::vector<Move> scramble;
+    for (int i = 0; i < 25; i++) scramble.push_back(static_cast<Move>(dist(rng)));
+    CubieCube c = CubieCube::fromMoves(scramble);
+
+    int canonSym = -1;
+    PackedCube canon = Symmetry::canonical(c, &canonSym);
+    EXPECT_TRUE(ctx, Symmetry::conjugate(c, canonSym).pack() == canon);
+
+    for (int s = 0; s < Symmetry::kCount; s++) {
+        CubieCube conj = Symmetry::conjugate(c, s);
+        Cube view;
+        view.setCubies(conj);
+        EXPECT_TRUE(ctx, view.isSolvable());
+        // Every member of the class maps to the same representative.
+        EXPECT_TRUE(ctx, Symmetry::canonical(conj) == canon);
+        EXPECT_EQ(ctx, Symmetry::cornerPermConj(c.cornerPerm(), s), conj.cornerPerm());
+        if (s < Symmetry::kUDCount) EXPECT_EQ(ctx, Symmetry::twistConj(c.twist(), s), conj.twist());
+
+        // Conjugated moves act on the conjugated state.
+        for (int m = 0; m < 18; m++) {
+            CubieCube moved = c;
+            moved.applyMove(static_cast<Move>(m));
+            CubieCube viaConj = conj;
+            viaConj.applyMove(Symmetry::conjugateMove(static_cast<Move>(m), s));
+            EXPECT_TRUE(ctx, Symmetry::conjugate(moved, s) == viaConj);
+        }
+
+        // A solution of the representative maps back to a solution of the original.
+        std::vector<Move> repSolution;
+        for (auto it = scramble.rbegin(); it != scramble.rend(); ++it) {
+            repSolution.push_back(Symmetry::conjugateMove(Cube::inverseMove(*it), s));
+        }
+        EXPECT_TRUE(ctx, (conj * CubieCube::fromMoves(repSolution)).isSolved());
+        EXPECT_TRUE(ctx, (c * CubieCube::fromMoves(Symmetry::mapSolution(repSolution, s))).isSolved());
+    }
+}
+
 static void test_isSolvable(TestCtx& ctx) {
     {
         Cube c;
@@ -397,31 +1551,122 @@ static void test_isSolvable(TestCtx& ctx) {
     }
 }
 
+static void test_solvability_reasons(TestCtx& ctx) {
+    auto check = [](const std::array<Color, 54>& s) {
+        Cube c;
+        c.setState(s);
+        return c.checkSolvable();
+    };
+    const auto solved = Cube().getState();
+
+    EXPECT_EQ(ctx, check(solved), Solvability::Solvable);
+
+    {
+        auto s = solved;
+        s[0] = static_cast<Color>(9);
+        EXPECT_EQ(ctx, check(s), Solvability::BadColor);
+    }
+    {
+        auto s = solved;
+        s[0] = Color::Yellow;
+        EXPECT_EQ(ctx, check(s), Solvability::BadColorCount);
+    }
+    {
+        // Swapping the U and D centres keeps colour counts but cannot be reached.
+        auto s = solved;
+        std::swap(s[FACE_U * 9 + 4], s[FACE_D * 9 + 4]);
+        EXPECT_EQ(ctx, check(s), Solvability::BadCentres);
+    }
+    {
+        // Swapping stickers of two different corners breaks both colour sets.
+        auto s = solved;
+        std::swap(s[FACE_U * 9 + 8], s[FACE_L * 9 + 8]);
+        EXPECT_EQ(ctx, check(s), Solvability::UnknownCorner);
+    }
+    {
+        // White and yellow stickers traded between URF and DBL: each shows another corner's
+        // colours in mirrored order, which no cubie can.
+        auto s = solved;
+        std::swap(s[FACE_U * 9 + 8], s[FACE_D * 9 + 6]);
+        EXPECT_EQ(ctx, check(s), Solvability::UnknownCorner);
+        // Also trading blue and green turns them into DLF and UBR, both already present.
+        std::swap(s[FACE_R * 9 + 0], s[FACE_L * 9 + 6]);
+        EXPECT_EQ(ctx, check(s), Solvability::DuplicateCorner);
+    }
+    {
+        // Two stickers of one corner swapped: the right colours, mirrored.
+        auto s = solved;
+        std::swap(s[FACE_R * 9 + 0], s[FACE_F * 9 + 2]);
+        EXPECT_EQ(ctx, check(s), Solvability::UnknownCorner);
+    }
+    {
+        // Twist the URF corner in place (U->R->F).
+        auto s = solved;
+        Color u = s[FACE_U * 9 + 8];
+        s[FACE_U * 9 + 8] = s[FACE_F * 9 + 2];
+        s[FACE_F * 9 + 2] = s[FACE_R * 9 + 0];
+        s[FACE_R * 9 + 0] = u;
+        EXPECT_EQ(ctx, check(s), Solvability::CornerTwist);
+    }
+    {
+        // Flip the UR edge in place.
+        auto s = solved;
+        std::swap(s[FACE_U * 9 + 5], s[FACE_R * 9 + 1]);
+        EXPECT_EQ(ctx, check(s), Solvability::EdgeFlip);
+    }
+    {
+        // Swap two whole edges (UR <-> UF): a single transposition.
+        auto s = solved;
+        std::swap(s[FACE_U * 9 + 5], s[FACE_U * 9 + 7]);
+        std::swap(s[FACE_R * 9 + 1], s[FACE_F * 9 + 1]);
+        EXPECT_EQ(ctx, check(s), Solvability::Parity);
+    }
+
+    std::mt19937 rng(17);
+    std::uniform_int_distribution<int> dist(0, 17);
+    Cube c;
+    for (int i = 0; i < 200; i++) {
+        c.applyMove(static_cast<Move>(dist(rng)));
+        EXPECT_EQ(ctx, c.checkSolvable(), Solvability::Solvable);
+    }
+    EXPECT_TRUE(ctx, std::string(Cube::solvabilityName(Solvability::Parity)).find("parity") != std::string::npos);
+}
+
 static void applyAll(Cube& cube, const std::vector<Move>& moves) {
     for (auto m : moves) cube.applyMove(m);
 }
 
 static void expect_state_solver(TestCtx& ctx, const std::vector<Move>& scramble) {
-    Solver solver;
     Cube source;
     source.reset();
     applyAll(source, scramble);
 
-    Cube cube;
-    cube.setState(source.getState());
-    Cube beforeSolve = cube;
-    auto solution = solver.solve(cube);
+    for (SolverMethod method : {SolverMethod::TwoPhase, SolverMethod::Bidirectional}) {
+        Solver solver(method);
+        Cube cube;
+        cube.setState(source.getState());
+        Cube beforeSolve = cube;
+        auto solution = solver.solve(cube);
 
-    EXPECT_TRUE(ctx, cube.getState() == beforeSolve.getState());
-    EXPECT_TRUE(ctx, !solution.empty());
+        EXPECT_TRUE(ctx, cube.getState() == beforeSolve.getState());
+        EXPECT_TRUE(ctx, !solution.empty());
 
-    Cube work = cube;
-    applyAll(work, solution);
-    EXPECT_TRUE(ctx, work.isSolved());
+        Cube work = cube;
+        applyAll(work, solution);
+        EXPECT_TRUE(ctx, work.isSolved());
+        EXPECT_TRUE(ctx, MoveSequence::simplified(solution) == solution);
+    }
 }
 
 static void test_solver_solves_each_move(TestCtx& ctx) {
     for (int i = 0; i < static_cast<int>(Move::COUNT); i++) {
+        Cube turned;
+        turned.applyMove(static_cast<Move>(i));
+        if (turned.isSolved()) {
+            // Whole-cube rotations leave nothing to solve.
+            EXPECT_TRUE(ctx, Solver().solve(turned).empty());
+            continue;
+        }
         expect_state_solver(ctx, {static_cast<Move>(i)});
     }
 }
@@ -458,6 +1703,63 @@ static void test_solver_uses_state_not_history(TestCtx& ctx) {
     EXPECT_TRUE(ctx, orphan.isSolved());
 }
 
+static void test_parallel_bidirectional_search(TestCtx& ctx) {
+    Solver serial(SolverMethod::Bidirectional, 1);
+    Solver parallel(SolverMethod::Bidirectional, 3);
+    EXPECT_EQ(ctx, parallel.threads(), 3u);
+    for (int i = 0; i < 6; i++) {
+        Cube cube;
+        cube.applyMoves(Scrambler::generate(24, static_cast<size_t>(i), 5 + i % 4));
+        SolverProgress progress;
+        auto solution = parallel.solve(cube, nullptr, &progress);
+        // Every meet within a layer has the same length, whichever worker finds it first.
+        EXPECT_EQ(ctx, solution.size(), serial.solve(cube).size());
+        EXPECT_TRUE(ctx, progress.nodes.load() > 0);
+        cube.applyMoves(solution);
+        EXPECT_TRUE(ctx, cube.isSolved());
+    }
+
+    // Out of reach: every layer is expanded and nothing is found.
+    Cube deep;
+    deep.applyMoves(Scrambler::generate(24, 99, 25));
+    EXPECT_TRUE(ctx, parallel.solve(deep).empty() || deep.isSolved());
+
+    // Cancelled mid-search: the layer being expanded stops and no further layer starts.
+    std::atomic_bool cancel{false};
+    SolverProgress progress;
+    int cancelledAt = 0;
+    std::thread canceller([&] {
+        while (progress.depth.load() < 3) std::this_thread::yield();
+        cancel = true;
+        cancelledAt = progress.depth.load();
+    });
+    EXPECT_TRUE(ctx, parallel.solve(deep, &cancel, &progress).empty());
+    canceller.join();
+    EXPECT_TRUE(ctx, progress.depth.load() <= cancelledAt + 1);
+}
+
+static void test_bidirectional_meet_sides(TestCtx& ctx) {
+    // Sides alternate start, solved, start, ...: odd lengths meet while the start side
+    // expands, even lengths while the solved side does (progress depth odd). Either way the
+    // path is rebuilt from last moves on both sides.
+    for (SolverMethod method : {SolverMethod::Bidirectional, SolverMethod::BidirectionalSlice}) {
+        Solver solver(method, 2);
+        for (int length = 1; length <= 8; length++) {
+            auto scramble = Scrambler::generate(25, static_cast<size_t>(length), length);
+            Cube cube;
+            cube.applyMoves(scramble);
+            SolverProgress progress;
+            auto solution = solver.solve(cube, nullptr, &progress);
+            EXPECT_TRUE(ctx, !solution.empty() && solution.size() <= scramble.size());
+            int expanding = progress.depth.load();
+            EXPECT_EQ(ctx, expanding, static_cast<int>(solution.size()) - 1);
+            EXPECT_EQ(ctx, expanding % 2 == 1, solution.size() % 2 == 0);
+            cube.applyMoves(solution);
+            EXPECT_TRUE(ctx, cube.isSolved());
+        }
+    }
+}
+
 static void test_solver_solved_is_empty(TestCtx& ctx) {
     Solver solver;
     Cube c;
@@ -466,20 +1768,164 @@ static void test_solver_solved_is_empty(TestCtx& ctx) {
     EXPECT_TRUE(ctx, sol.empty());
 }
 
+static void test_two_phase_solver(TestCtx& ctx) {
+    const TwoPhaseTables& t = TwoPhaseTables::get();
+    CubieCube solved;
+    EXPECT_EQ(ctx, (int)t.twistSlice[static_cast<size_t>(solved.slice()) * CoordTables::kTwist], 0);
+    EXPECT_EQ(ctx, (int)*std::max_element(t.twistSlice.begin(), t.twistSlice.end()), 9);
+    EXPECT_EQ(ctx, (int)*std::max_element(t.flipSlice.begin(), t.flipSlice.end()), 9);
+    EXPECT_EQ(ctx, (int)*std::max_element(t.cornerSlice.begin(), t.cornerSlice.end()), 14);
+    EXPECT_EQ(ctx, (int)*std::max_element(t.udEdgesSlice.begin(), t.udEdgesSlice.end()), 12);
+
+    // Uniformly random states are about 18 moves deep; the bidirectional BFS never reached them.
+    RandomStateGenerator gen(2101);
+    Solver solver;
+    size_t longest = 0;
+    for (int i = 0; i < 30; i++) {
+        Cube cube;
+        cube.setCubies(gen.next());
+        SolverProgress progress;
+        auto solution = solver.solve(cube, nullptr, &progress);
+        EXPECT_TRUE(ctx, !solution.empty());
+        EXPECT_TRUE(ctx, progress.nodes.load() > 0);
+        longest = std::max(longest, solution.size());
+        EXPECT_TRUE(ctx, MoveSequence::simplified(solution) == solution);
+        cube.applyMoves(solution);
+        EXPECT_TRUE(ctx, cube.isSolved());
+    }
+    EXPECT_TRUE(ctx, longest <= 23);
+
+    // Superflip: every edge flipped in place, 20 moves from solved and among the hardest
+    // states for the phase-1 tables.
+    CubieCube superflip;
+    superflip.setFlip(CoordTables::kFlip - 1);
+    auto solution = TwoPhaseSolver::solve(superflip);
+    EXPECT_TRUE(ctx, solution.size() >= 20 && solution.size() <= 23);
+    EXPECT_TRUE(ctx, (superflip * CubieCube::fromMoves(solution)).isSolved());
+
+    std::atomic_bool cancel{true};
+    Cube cube;
+    cube.setCubies(gen.next());
+    EXPECT_TRUE(ctx, solver.solve(cube, &cancel).empty());
+    EXPECT_TRUE(ctx, TwoPhaseSolver::solve(cube.cubies(), &cancel).empty());
+    // Short searches never reach the periodic poll; cancel must still win.
+    EXPECT_TRUE(ctx, TwoPhaseSolver::solve(CubieCube::fromMoves({Move::R}), &cancel).empty());
+}
+
+static void test_optimal_solver(TestCtx& ctx) {
+    const OptimalTables& t = OptimalTables::get();
+    EXPECT_EQ(ctx, t.cornerClasses, OptimalTables::kMaxCornerClasses);
+    EXPECT_EQ(ctx, t.cornerDistance(0, 0), 0);
+    int cornerMax = 0;
+    for (size_t i = 0; i < static_cast<size_t>(t.cornerClasses) * CoordTables::kTwist; i++) {
+        cornerMax = std::max(cornerMax, OptimalTables::nibble(t.corners, i));
+    }
+    int edgeMax = 0;
+    for (size_t i = 0; i < OptimalTables::kEdgeEntries; i++) edgeMax = std::max(edgeMax, OptimalTables::nibble(t.edges, i));
+    EXPECT_EQ(ctx, cornerMax, 11);  // known depth of the corner group
+    EXPECT_EQ(ctx, edgeMax, 10);
+
+    // The corner bound is symmetric: a state and its U-D conjugates are equally far.
+    RandomStateGenerator gen(2201);
+    for (int i = 0; i < 200; i++) {
+        CubieCube c = gen.next();
+        CubieCube conj = Symmetry::conjugate(c, i % Symmetry::kUDCount);
+        EXPECT_EQ(ctx, t.cornerDistance(c.cornerPerm(), c.twist()), t.cornerDistance(conj.cornerPerm(), conj.twist()));
+    }
+
+    // Same lengths as the optimal bidirectional search where that one reaches.
+    Solver optimal(SolverMethod::Optimal);
+    Solver bidirectional(SolverMethod::Bidirectional);
+    for (int i = 0; i < 12; i++) {
+        Cube cube;
+        cube.applyMoves(Scrambler::generate(22, static_cast<size_t>(i), 4 + i % 5));
+        SolverProgress progress;
+        auto solution = optimal.solve(cube, nullptr, &progress);
+        EXPECT_EQ(ctx, solution.size(), bidirectional.solve(cube).size());
+        EXPECT_EQ(ctx, progress.depth.load(), (int)solution.size());
+        cube.applyMoves(solution);
+        EXPECT_TRUE(ctx, cube.isSolved());
+    }
+
+    // Deeper than the bidirectional search can go, and never longer than the scramble.
+    for (int i = 0; i < 3; i++) {
+        auto scramble = Scrambler::generate(23, static_cast<size_t>(i), 12);
+        CubieCube c = CubieCube::fromMoves(scramble);
+        auto solution = OptimalSolver::solve(c);
+        EXPECT_TRUE(ctx, !solution.empty() && solution.size() <= scramble.size());
+        EXPECT_TRUE(ctx, (c * CubieCube::fromMoves(solution)).isSolved());
+        EXPECT_TRUE(ctx, OptimalSolver::solve(c, nullptr, nullptr, static_cast<int>(solution.size()) - 1).empty());
+        // Split over several workers: possibly a different solution, never a longer one.
+        auto parallel = OptimalSolver::solve(c, nullptr, nullptr, OptimalSolver::kMaxLength, 4);
+        EXPECT_EQ(ctx, parallel.size(), solution.size());
+        EXPECT_TRUE(ctx, (c * CubieCube::fromMoves(parallel)).isSolved());
+    }
+
+    std::atomic_bool cancel{true};
+    EXPECT_TRUE(ctx, OptimalSolver::solve(gen.next(), &cancel).empty());
+    EXPECT_TRUE(ctx, OptimalSolver::solve(CubieCube::fromMoves({Move::R}), &cancel).empty());
+}
+
+static void test_work_stealing_pool(TestCtx& ctx) {
+    for (unsigned threads : {1u, 3u}) {
+        WorkStealingPool pool(threads);
+        EXPECT_EQ(ctx, pool.size(), threads);
+        // Several runs on one pool, tasks of uneven cost: each index runs exactly once.
+        for (size_t count : {size_t(0), size_t(1), size_t(7), size_t(1000)}) {
+            std::vector<std::atomic<int>> runs(count);
+            std::atomic<bool> badWorker{false};
+            pool.run(count, [&](size_t i, unsigned worker) {
+                if (worker >= pool.size()) badWorker = true;
+                volatile uint64_t spin = 0;
+                for (size_t k = 0; k < (i % 17) * 1000; k++) spin = spin + k;
+                runs[i].fetch_add(1);
+            });
+            bool once = true;
+            for (auto& r : runs) once = once && r.load() == 1;
+            EXPECT_TRUE(ctx, once);
+            EXPECT_TRUE(ctx, !badWorker.load());
+        }
+    }
+}
+
 int main() {
     TestCtx ctx;
 
     test_faceletIndexFor_roundtrip(ctx);
     test_reset_color_scheme(ctx);
     test_move_matches_physical_model(ctx);
+    test_move_tables_match_reference(ctx);
+    test_simd_kernel_matches_scalar(ctx);
+    test_move_sequence_fusion(ctx);
+    test_move_sequence_simplify(ctx);
+    test_move_automaton(ctx);
+    test_notation(ctx);
+    test_batch_file(ctx);
+    test_random_state_generator(ctx);
+    test_seeded_scrambles(ctx);
+    test_incremental_misplaced_counter(ctx);
+    test_incremental_hash(ctx);
+    test_nxn_cubes(ctx);
+    test_slice_wide_rotation_moves(ctx);
     test_inverse_and_identity(ctx);
     test_color_count_invariant(ctx);
     test_corner_edge_validity_invariants(ctx);
+    test_cubie_form_matches_facelets(ctx);
+    test_coordinates_roundtrip_and_tables(ctx);
+    test_packed_state(ctx);
+    test_cubie_group_algebra(ctx);
+    test_symmetry_reduction(ctx);
     test_isSolvable(ctx);
+    test_solvability_reasons(ctx);
     test_solver_solved_is_empty(ctx);
     test_solver_solves_each_move(ctx);
     test_solver_solves_raw_scrambles(ctx);
     test_solver_uses_state_not_history(ctx);
+    test_parallel_bidirectional_search(ctx);
+    test_bidirectional_meet_sides(ctx);
+    test_two_phase_solver(ctx);
+    test_work_stealing_pool(ctx);
+    test_optimal_solver(ctx);
 
     std::cerr << "Assertions: " << ctx.assertions << ", Failures: " << ctx.failures << "\n";
     return (ctx.failures == 0) ? 0 : 1;